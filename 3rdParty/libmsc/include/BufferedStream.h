@@ -0,0 +1,103 @@
+
+/** $VER: BufferedStream.h (2026.10.19) P. Stuer **/
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Stream.h"
+
+#pragma warning(disable: 4820)
+
+namespace msc
+{
+
+/// <summary>
+/// Implements a stream that buffers the reads from another stream. Small reads, skips and moves within the buffer don't access the other stream.
+/// Optionally the next buffer is read ahead on a background thread while the current one is being consumed (double buffering).
+/// The other stream is not owned by this stream and must outlive it.
+/// </summary>
+class buffered_stream_t : public stream_t
+{
+public:
+    buffered_stream_t(stream_t & stream, size_t bufferSize = 65536, bool readAhead = false);
+
+    buffered_stream_t(const buffered_stream_t &) = delete;
+    buffered_stream_t & operator=(const buffered_stream_t &) = delete;
+    buffered_stream_t(buffered_stream_t &&) = delete;
+    buffered_stream_t & operator=(buffered_stream_t &&) = delete;
+
+    virtual ~buffered_stream_t()
+    {
+        Close();
+    }
+
+    virtual void Close() noexcept;
+    virtual void Read(void * data, uint64_t size);
+    virtual void Write(const void * data, uint64_t size);
+    virtual void Skip(uint64_t size);
+
+    /// <summary>
+    /// Gets the current offset.
+    /// </summary>
+    virtual uint64_t Offset() const
+    {
+        return _Front.Offset + _Curr;
+    }
+
+    virtual void Offset(uint64_t offset);
+
+    /// <summary>
+    /// Gets the size of the stream.
+    /// </summary>
+    virtual uint64_t Size() const
+    {
+        return _StreamSize;
+    }
+
+private:
+    struct buffer_t
+    {
+        std::vector<uint8_t> Data;
+        uint64_t Offset;        // Offset of the data in the stream
+        size_t Size;            // Number of valid bytes
+    };
+
+    enum class state_t
+    {
+        Idle,                   // The back buffer is not in use.
+        Pending,                // The back buffer is being filled.
+        Ready,                  // The back buffer has been filled, or an error occured.
+    };
+
+    void Fill();
+    void Request(uint64_t offset);
+    void Invalidate(uint64_t offset);
+    void WaitWhilePending(std::unique_lock<std::mutex> & lock);
+
+    void Run(std::stop_token stopToken) noexcept;
+
+private:
+    stream_t & _Stream;
+    uint64_t _StreamSize;
+    size_t _BufferSize;
+
+    buffer_t _Front;            // Buffer being consumed
+    size_t _Curr;               // Offset of the next byte to read in the front buffer
+    uint64_t _NextOffset;       // Offset of the data following the front buffer
+
+    // Read-ahead
+    bool _ReadAhead;
+    buffer_t _Back;
+    state_t _State;
+    std::exception_ptr _Error;
+    std::mutex _Mutex;
+    std::condition_variable _Condition;
+    std::jthread _Thread;
+};
+
+}
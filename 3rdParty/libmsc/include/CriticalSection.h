@@ -1,11 +1,17 @@
 
-/** $VER: CriticalSection.h (2025.09.14) P. Stuer **/
+/** $VER: CriticalSection.h (2026.10.19) P. Stuer **/
 
 #pragma once
 
+#ifndef _WIN32
+#include "Lock.h"
+#endif
+
 namespace msc
 {
 
+#ifdef _WIN32
+
 class critical_section_t
 {
 public:
@@ -48,4 +54,37 @@ private:
     CRITICAL_SECTION _cs;
 };
 
+#else
+
+class critical_section_t
+{
+public:
+    critical_section_t() noexcept { }
+
+    critical_section_t(const critical_section_t &) = delete;
+    critical_section_t & operator=(const critical_section_t &) = delete;
+    critical_section_t(critical_section_t &&) = delete;
+    critical_section_t & operator=(critical_section_t &&) = delete;
+
+    void Enter() noexcept
+    {
+        _Mutex.lock();
+    }
+
+    bool TryEnter() noexcept
+    {
+        return _Mutex.try_lock();
+    }
+
+    void Leave() noexcept
+    {
+        _Mutex.unlock();
+    }
+
+private:
+    mutex_t _Mutex;
+};
+
+#endif
+
 }
@@ -1,8 +1,19 @@
 
-/** $VER: Encoding.h (2025.09.01) P. Stuer **/
+/** $VER: Encoding.h (2026.10.19) P. Stuer **/
 
 #pragma once
 
+#include <cstdarg>
+#include <string>
+
+#if __has_include(<format>)
+#include <format>
+#endif
+
+#ifndef CP_UTF8
+#define CP_UTF8 65001
+#endif
+
 namespace msc
 {
 
@@ -38,7 +49,43 @@ inline std::wstring UTF8ToWide(const std::string & text) noexcept
 }
 
 std::string FormatText(const char * format, ...) noexcept;
+std::string FormatTextV(const char * format, va_list args) noexcept;
+size_t FormatTextTo(char * buffer, size_t size, const char * format, ...) noexcept;
+
 std::wstring FormatText(const wchar_t * format, ...) noexcept;
+std::wstring FormatTextV(const wchar_t * format, va_list args) noexcept;
+
+#if __has_include(<format>)
+/// <summary>
+/// Formats a string using the std::format syntax. The arguments are checked at compile time instead of being parsed from a variable argument list.
+/// Text of up to 256 characters is formatted into a buffer on the stack first.
+/// </summary>
+template<typename... Args>
+std::string Format(std::format_string<Args...> format, Args && ... args)
+{
+    char Buffer[256];
+
+    const auto Result = std::format_to_n(Buffer, sizeof(Buffer), format, std::forward<Args>(args)...);
+
+    if ((size_t) Result.size <= sizeof(Buffer))
+        return std::string(Buffer, (size_t) Result.size);
+
+    return std::vformat(format.get(), std::make_format_args(args...));
+}
+#endif
+
+/// <summary>
+/// Represents the encodings that are valid for a text.
+/// </summary>
+struct text_encodings_t
+{
+    bool IsASCII;
+    bool IsUTF8;
+    bool IsShiftJIS;
+    bool IsEUCJP;
+};
+
+text_encodings_t DetectEncodings(const char * text, size_t size) noexcept;
 
 bool IsEUCJP(const char * text, size_t size) noexcept;
 bool IsShiftJIS(const char * text, size_t size) noexcept;
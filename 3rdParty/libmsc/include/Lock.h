@@ -0,0 +1,268 @@
+
+/** $VER: Lock.h (2026.10.19) P. Stuer **/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace msc
+{
+
+/// <summary>
+/// Tells the processor that the thread is spinning.
+/// </summary>
+inline void CpuRelax() noexcept
+{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    __asm__ __volatile__("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/// <summary>
+/// Implements a mutex that spins for a short time before it waits. Waiting uses std::atomic::wait() which maps to a futex on Linux and WaitOnAddress() on Windows.
+/// The state is 0 if unlocked, 1 if locked and 2 if locked and other threads may be waiting. Unlocking only wakes a thread when the state is 2.
+/// </summary>
+class mutex_t
+{
+public:
+    mutex_t() noexcept : _State(0) { }
+
+    mutex_t(const mutex_t &) = delete;
+    mutex_t & operator=(const mutex_t &) = delete;
+
+    void lock() noexcept
+    {
+        uint32_t State = 0;
+
+        if (_State.compare_exchange_strong(State, 1, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+
+        for (int i = 0; i < SpinCount; ++i)
+        {
+            CpuRelax();
+
+            State = 0;
+
+            if ((_State.load(std::memory_order_relaxed) == 0) && _State.compare_exchange_weak(State, 1, std::memory_order_acquire, std::memory_order_relaxed))
+                return;
+        }
+
+        while (_State.exchange(2, std::memory_order_acquire) != 0)
+            _State.wait(2, std::memory_order_relaxed);
+    }
+
+    bool try_lock() noexcept
+    {
+        uint32_t State = 0;
+
+        return _State.compare_exchange_strong(State, 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept
+    {
+        if (_State.exchange(0, std::memory_order_release) == 2)
+            _State.notify_one();
+    }
+
+private:
+    static const int SpinCount = 100;
+
+    std::atomic<uint32_t> _State;
+};
+
+/// <summary>
+/// Implements a reader-writer lock for read-mostly data. Any number of readers can hold the lock at the same time.
+/// A writer that is waiting blocks new readers so it can't be starved.
+/// </summary>
+class rw_lock_t
+{
+public:
+    rw_lock_t() noexcept : _State(0) { }
+
+    rw_lock_t(const rw_lock_t &) = delete;
+    rw_lock_t & operator=(const rw_lock_t &) = delete;
+
+    void lock_shared() noexcept
+    {
+        for (int i = 0;; ++i)
+        {
+            uint32_t State = _State.load(std::memory_order_relaxed);
+
+            if ((State & Writer) == 0)
+            {
+                if (_State.compare_exchange_weak(State, State + 1, std::memory_order_acquire, std::memory_order_relaxed))
+                    return;
+
+                continue;
+            }
+
+            if (i < SpinCount)
+                CpuRelax();
+            else
+                _State.wait(State, std::memory_order_relaxed);
+        }
+    }
+
+    bool try_lock_shared() noexcept
+    {
+        uint32_t State = _State.load(std::memory_order_relaxed);
+
+        return ((State & Writer) == 0) && _State.compare_exchange_strong(State, State + 1, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock_shared() noexcept
+    {
+        // Wake the writer when the last reader leaves.
+        if (_State.fetch_sub(1, std::memory_order_release) == Writer + 1)
+            _State.notify_all();
+    }
+
+    void lock() noexcept
+    {
+        // Claim the writer bit. This stops new readers.
+        for (int i = 0;; ++i)
+        {
+            uint32_t State = _State.load(std::memory_order_relaxed);
+
+            if ((State & Writer) == 0)
+            {
+                if (_State.compare_exchange_weak(State, State | Writer, std::memory_order_acquire, std::memory_order_relaxed))
+                    break;
+
+                continue;
+            }
+
+            if (i < SpinCount)
+                CpuRelax();
+            else
+                _State.wait(State, std::memory_order_relaxed);
+        }
+
+        // Wait for the current readers to leave.
+        for (int i = 0;; ++i)
+        {
+            const uint32_t State = _State.load(std::memory_order_acquire);
+
+            if (State == Writer)
+                return;
+
+            if (i < SpinCount)
+                CpuRelax();
+            else
+                _State.wait(State, std::memory_order_acquire);
+        }
+    }
+
+    bool try_lock() noexcept
+    {
+        uint32_t State = 0;
+
+        return _State.compare_exchange_strong(State, Writer, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() noexcept
+    {
+        _State.store(0, std::memory_order_release);
+        _State.notify_all();
+    }
+
+private:
+    static const uint32_t Writer = 0x80000000u;
+    static const int SpinCount = 100;
+
+    std::atomic<uint32_t> _State; // Writer bit and number of readers
+};
+
+/// <summary>
+/// Implements a sequence lock that lets readers take consistent snapshots of a small value, e.g. telemetry, without ever blocking the writer.
+/// Readers retry when the value was changed while they were copying it. Only one thread may write at a time.
+/// </summary>
+template<typename T>
+class seq_lock_t
+{
+    static_assert(std::is_trivially_copyable_v<T>, "seq_lock_t requires a trivially copyable type");
+
+public:
+    seq_lock_t() noexcept : _Sequence(0), _Data() { }
+
+    seq_lock_t(const T & value) noexcept : _Sequence(0)
+    {
+        Store(value);
+    }
+
+    seq_lock_t(const seq_lock_t &) = delete;
+    seq_lock_t & operator=(const seq_lock_t &) = delete;
+
+    /// <summary>
+    /// Stores a new value.
+    /// </summary>
+    void Store(const T & value) noexcept
+    {
+        uint64_t Words[WordCount] = { };
+
+        ::memcpy(Words, &value, sizeof(T));
+
+        const uint32_t Sequence = _Sequence.load(std::memory_order_relaxed);
+
+        _Sequence.store(Sequence + 1, std::memory_order_relaxed); // Odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WordCount; ++i)
+            _Data[i].store(Words[i], std::memory_order_relaxed);
+
+        _Sequence.store(Sequence + 2, std::memory_order_release);
+    }
+
+    /// <summary>
+    /// Loads a consistent copy of the value.
+    /// </summary>
+    T Load() const noexcept
+    {
+        uint64_t Words[WordCount];
+
+        for (;;)
+        {
+            const uint32_t Sequence = _Sequence.load(std::memory_order_acquire);
+
+            if ((Sequence & 1) != 0)
+            {
+                CpuRelax();
+                continue;
+            }
+
+            for (size_t i = 0; i < WordCount; ++i)
+                Words[i] = _Data[i].load(std::memory_order_relaxed);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (_Sequence.load(std::memory_order_relaxed) == Sequence)
+                break;
+        }
+
+        T Value;
+
+        ::memcpy(&Value, Words, sizeof(T));
+
+        return Value;
+    }
+
+private:
+    static constexpr size_t WordCount = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint32_t> _Sequence;
+    std::atomic<uint64_t> _Data[WordCount];
+};
+
+}
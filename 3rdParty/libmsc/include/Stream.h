@@ -1,10 +1,14 @@
 
-/** $VER: Stream.h (2025.09.06) P. Stuer **/
+/** $VER: Stream.h (2026.10.19) P. Stuer **/
 
 #pragma once
 
+#ifdef _WIN32
 #include <SDKDDKVer.h>
 #include <windows.h>
+#endif
+
+#include <cstring>
 
 #include "Exception.h"
 
@@ -13,6 +17,14 @@
 namespace msc
 {
 
+#ifdef _WIN32
+typedef HANDLE native_handle_t;
+inline const native_handle_t InvalidNativeHandle = INVALID_HANDLE_VALUE;
+#else
+typedef int native_handle_t;
+inline const native_handle_t InvalidNativeHandle = -1;
+#endif
+
 /// <summary>
 /// Implements a stream.
 /// </summary>
@@ -47,6 +59,11 @@ public:
     /// Moves to the specified offset.
     /// </summary>
     virtual void Offset(uint64_t size) = 0;
+
+    /// <summary>
+    /// Gets the size of the stream.
+    /// </summary>
+    virtual uint64_t Size() const = 0;
 };
 
 /// <summary>
@@ -55,7 +72,7 @@ public:
 class file_stream_t : public stream_t
 {
 public:
-    file_stream_t() noexcept : _hFile(INVALID_HANDLE_VALUE)
+    file_stream_t() noexcept : _hFile(InvalidNativeHandle), _Offset()
     {
     }
 
@@ -72,9 +89,11 @@ public:
     virtual void Skip(uint64_t size);
     virtual uint64_t Offset() const;
     virtual void Offset(uint64_t size);
+    virtual uint64_t Size() const;
 
 protected:
-    HANDLE _hFile;
+    native_handle_t _hFile;
+    uint64_t _Offset;           // Current offset. Only used by the POSIX implementation which reads and writes at an explicit offset.
 };
 
 /// <summary>
@@ -83,10 +102,15 @@ protected:
 class memory_stream_t : public stream_t
 {
 public:
-    memory_stream_t() noexcept : _hFile(INVALID_HANDLE_VALUE), _hMap(), _Data(), _Curr(), _Tail()
+    memory_stream_t() noexcept : _hFile(InvalidNativeHandle), _hMap(), _MapSize(), _Data(), _Curr(), _Tail(), _IsZeroTerminated()
     {
     }
 
+    virtual ~memory_stream_t()
+    {
+        Close();
+    }
+
     bool Open(const fs::path & filePath, uint64_t offset, uint64_t size, bool forWriting = false);
 
     bool Open(const uint8_t * data, uint64_t size);
@@ -141,13 +165,44 @@ public:
         _Curr = _Data + (ptrdiff_t) size;
     }
 
+    /// <summary>
+    /// Gets a pointer to the data of the stream.
+    /// </summary>
+    const uint8_t * Data() const noexcept
+    {
+        return _Data;
+    }
+
+    /// <summary>
+    /// Gets the size of the data of the stream.
+    /// </summary>
+    virtual uint64_t Size() const noexcept
+    {
+        return (uint64_t) (_Tail - _Data);
+    }
+
+    /// <summary>
+    /// Returns true if the byte following the data is guaranteed to be 0, i.e. the data can be used as a C string without copying it.
+    /// </summary>
+    bool IsZeroTerminated() const noexcept
+    {
+        return _IsZeroTerminated;
+    }
+
 protected:
-    HANDLE _hFile;
+    native_handle_t _hFile;
+#ifdef _WIN32
     HANDLE _hMap;
+#else
+    void * _hMap;               // Start of the mapping. The data starts at an offset if the requested offset is not page-aligned.
+#endif
+    size_t _MapSize;
 
     uint8_t * _Data;
     uint8_t * _Curr;
     uint8_t * _Tail;
+
+    bool _IsZeroTerminated;
 };
 
 }
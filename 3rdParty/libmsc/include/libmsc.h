@@ -1,8 +1,9 @@
 
-/** $VER: libmsc.h (2025.09.17) P. Stuer - My Support Classes, The "Most Original Name" Winner **/
+/** $VER: libmsc.h (2026.10.19) P. Stuer - My Support Classes, The "Most Original Name" Winner **/
 
 #pragma once
 
+#ifdef _WIN32
 // UTF-8 Everywhere recommendation
 #ifndef _UNICODE
 #error Unicode character set compilation not enabled.
@@ -10,15 +11,27 @@
 
 #include <SDKDDKVer.h>
 #include <windows.h>
+#endif
 
+#include <cstdint>
 #include <filesystem>
+#include <string>
+#include <vector>
 
 namespace fs = std::filesystem;
 
 #include "CriticalSection.h"
 #include "Encoding.h"
+#ifdef _WIN32
 #include "Enum.h"
+#endif
 #include "Exception.h"
+#include "Lock.h"
+#ifdef _WIN32
 #include "RAII.h"
+#endif
 #include "Stream.h"
+#include "BufferedStream.h"
+#ifdef _WIN32
 #include "Support.h"
+#endif
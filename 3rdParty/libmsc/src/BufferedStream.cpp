@@ -0,0 +1,276 @@
+
+/** $VER: BufferedStream.cpp (2026.10.19) P. Stuer **/
+
+#include "pch.h"
+
+#include "BufferedStream.h"
+
+#include <utility>
+
+namespace msc
+{
+
+/// <summary>
+/// Initializes a new instance. The other stream is owned by the caller. It must stay valid while this stream is used and is not closed when this stream is closed.
+/// </summary>
+buffered_stream_t::buffered_stream_t(stream_t & stream, size_t bufferSize, bool readAhead) : _Stream(stream), _StreamSize(stream.Size()), _BufferSize(bufferSize), _Front(), _Curr(), _NextOffset(), _ReadAhead(readAhead), _Back(), _State(state_t::Idle)
+{
+    if (_BufferSize == 0)
+        throw exception("Invalid buffer size");
+
+    _Front.Offset = _NextOffset = _Stream.Offset();
+    _Front.Data.resize(_BufferSize);
+
+    if (_ReadAhead)
+    {
+        _Back.Data.resize(_BufferSize);
+
+        _Thread = std::jthread([this](std::stop_token stopToken) { Run(stopToken); });
+
+        Request(_NextOffset);
+    }
+}
+
+/// <summary>
+/// Closes the stream. Stops the read-ahead. The other stream is owned by the caller and is not closed.
+/// </summary>
+void buffered_stream_t::Close() noexcept
+{
+    if (_Thread.joinable())
+    {
+        _Thread.request_stop();
+
+        {
+            std::lock_guard Lock(_Mutex);
+        }
+
+        _Condition.notify_all();
+
+        _Thread.join();
+    }
+
+    _Front.Size = 0;
+    _Curr = 0;
+}
+
+/// <summary>
+/// Reads a number of bytes.
+/// </summary>
+void buffered_stream_t::Read(void * data, uint64_t size)
+{
+    if (Offset() + size > _StreamSize)
+        throw exception("Insufficient data");
+
+    auto Data = (uint8_t *) data;
+
+    while (size != 0)
+    {
+        const size_t Available = _Front.Size - _Curr;
+
+        if (Available == 0)
+        {
+            // Bypass the buffer for large reads.
+            if (!_ReadAhead && (size >= _BufferSize))
+            {
+                _Stream.Read(Data, size);
+
+                _NextOffset += size;
+
+                _Front.Offset = _NextOffset;
+                _Front.Size = 0;
+                _Curr = 0;
+
+                return;
+            }
+
+            Fill();
+
+            continue;
+        }
+
+        const size_t Size = (size_t) std::min((uint64_t) Available, size);
+
+        ::memcpy(Data, _Front.Data.data() + _Curr, Size);
+
+        _Curr += Size;
+        Data  += Size;
+        size  -= Size;
+    }
+}
+
+/// <summary>
+/// Writes a number of bytes. The buffer is discarded and the data is written directly to the other stream.
+/// </summary>
+void buffered_stream_t::Write(const void * data, uint64_t size)
+{
+    const uint64_t Offset = this->Offset();
+
+    Invalidate(Offset);
+
+    if (_ReadAhead)
+        _Stream.Offset(Offset);
+
+    _Stream.Write(data, size);
+
+    _StreamSize = std::max(_StreamSize, Offset + size);
+
+    Invalidate(Offset + size);
+}
+
+/// <summary>
+/// Skips the specified number of bytes.
+/// </summary>
+void buffered_stream_t::Skip(uint64_t size)
+{
+    if (_Curr + size <= _Front.Size)
+        _Curr += (size_t) size;
+    else
+        Offset(Offset() + size);
+}
+
+/// <summary>
+/// Moves to the specified offset.
+/// </summary>
+void buffered_stream_t::Offset(uint64_t offset)
+{
+    if ((offset >= _Front.Offset) && (offset <= _Front.Offset + _Front.Size))
+        _Curr = (size_t) (offset - _Front.Offset);
+    else
+        Invalidate(offset);
+}
+
+/// <summary>
+/// Refills the front buffer with the data that follows it.
+/// </summary>
+void buffered_stream_t::Fill()
+{
+    if (_ReadAhead)
+    {
+        std::unique_lock Lock(_Mutex);
+
+        if ((_State == state_t::Idle) || ((_State == state_t::Ready) && (_Back.Offset != _NextOffset)))
+        {
+            _Back.Offset = _NextOffset;
+            _State = state_t::Pending;
+
+            _Condition.notify_all();
+        }
+
+        WaitWhilePending(Lock);
+
+        _State = state_t::Idle;
+
+        if (_Error)
+            std::rethrow_exception(std::exchange(_Error, nullptr));
+
+        std::swap(_Front, _Back);
+    }
+    else
+    {
+        _Front.Offset = _NextOffset;
+        _Front.Size = (size_t) std::min((uint64_t) _BufferSize, _StreamSize - _NextOffset);
+
+        _Stream.Read(_Front.Data.data(), _Front.Size);
+    }
+
+    _Curr = 0;
+    _NextOffset = _Front.Offset + _Front.Size;
+
+    if (_ReadAhead && (_NextOffset < _StreamSize))
+        Request(_NextOffset);
+}
+
+/// <summary>
+/// Requests the background thread to read the data at the specified offset into the back buffer.
+/// </summary>
+void buffered_stream_t::Request(uint64_t offset)
+{
+    {
+        std::lock_guard Lock(_Mutex);
+
+        _Back.Offset = offset;
+        _State = state_t::Pending;
+    }
+
+    _Condition.notify_all();
+}
+
+/// <summary>
+/// Discards the buffered data and continues reading at the specified offset.
+/// </summary>
+void buffered_stream_t::Invalidate(uint64_t offset)
+{
+    if (_ReadAhead)
+    {
+        std::unique_lock Lock(_Mutex);
+
+        WaitWhilePending(Lock);
+
+        _State = state_t::Idle;
+        _Error = nullptr;
+    }
+    else
+        _Stream.Offset(offset);
+
+    _Front.Offset = offset;
+    _Front.Size = 0;
+    _Curr = 0;
+    _NextOffset = offset;
+}
+
+/// <summary>
+/// Waits until the background thread has finished filling the back buffer.
+/// </summary>
+void buffered_stream_t::WaitWhilePending(std::unique_lock<std::mutex> & lock)
+{
+    _Condition.wait(lock, [this] { return _State != state_t::Pending; });
+}
+
+/// <summary>
+/// Fills the back buffer when requested. Only this thread accesses the other stream while read-ahead is enabled.
+/// </summary>
+void buffered_stream_t::Run(std::stop_token stopToken) noexcept
+{
+    for (;;)
+    {
+        uint64_t Offset;
+
+        {
+            std::unique_lock Lock(_Mutex);
+
+            _Condition.wait(Lock, [this, &stopToken] { return (_State == state_t::Pending) || stopToken.stop_requested(); });
+
+            if (stopToken.stop_requested())
+                return;
+
+            Offset = _Back.Offset;
+        }
+
+        std::exception_ptr Error;
+        size_t Size = 0;
+
+        try
+        {
+            Size = (size_t) std::min((uint64_t) _BufferSize, _StreamSize - std::min(Offset, _StreamSize));
+
+            _Stream.Offset(Offset);
+            _Stream.Read(_Back.Data.data(), Size);
+        }
+        catch (...)
+        {
+            Error = std::current_exception();
+        }
+
+        {
+            std::lock_guard Lock(_Mutex);
+
+            _Back.Size = Size;
+            _Error = Error;
+            _State = state_t::Ready;
+        }
+
+        _Condition.notify_all();
+    }
+}
+
+}
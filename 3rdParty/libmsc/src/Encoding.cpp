@@ -1,10 +1,14 @@
 
-/** $VER: Encoding.cpp (2025.09.06) P. Stuer - Encoding conversion routines **/
+/** $VER: Encoding.cpp (2026.10.19) P. Stuer - Encoding conversion routines **/
 
 #include "pch.h"
 
 #include <map>
 
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace msc
 {
 
@@ -25,6 +29,7 @@ static const std::map<const std::string, uint32_t> EncodingToCodePage
     { "windows-1258",    1258 },    // Vietnamese
 };
 
+#ifdef _WIN32
 /// <summary>
 /// Converts an UTF-16 string of UTF-8.
 /// </summary>
@@ -60,6 +65,127 @@ std::wstring CodePageToWide(uint32_t codePage, const char * text, size_t size) n
     return Wide;
 }
 
+#else
+/// <summary>
+/// Converts a wide string to UTF-8. wchar_t holds UTF-32 on POSIX systems.
+/// </summary>
+std::string WideToUTF8(const wchar_t * wide, size_t size = 0) noexcept
+{
+    if (size == 0)
+        size = ::wcslen(wide);
+
+    std::string UTF8;
+
+    try
+    {
+        UTF8.reserve(size);
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            uint32_t c = (uint32_t) wide[i];
+
+            if ((c > 0x10FFFF) || ((c >= 0xD800) && (c <= 0xDFFF)))
+                c = 0xFFFD;
+
+            if (c < 0x80)
+                UTF8 += (char) c;
+            else
+            if (c < 0x800)
+            {
+                UTF8 += (char) (0xC0 | (c >> 6));
+                UTF8 += (char) (0x80 | (c & 0x3F));
+            }
+            else
+            if (c < 0x10000)
+            {
+                UTF8 += (char) (0xE0 | (c >> 12));
+                UTF8 += (char) (0x80 | ((c >> 6) & 0x3F));
+                UTF8 += (char) (0x80 | (c & 0x3F));
+            }
+            else
+            {
+                UTF8 += (char) (0xF0 | (c >> 18));
+                UTF8 += (char) (0x80 | ((c >> 12) & 0x3F));
+                UTF8 += (char) (0x80 | ((c >> 6) & 0x3F));
+                UTF8 += (char) (0x80 | (c & 0x3F));
+            }
+        }
+    }
+    catch (...)
+    {
+        return std::string();
+    }
+
+    return UTF8;
+}
+
+/// <summary>
+/// Converts a string encoded with the specified code page to a wide string. Only UTF-8 is supported on POSIX systems; other code pages return an empty string.
+/// Invalid sequences are replaced by U+FFFD.
+/// </summary>
+std::wstring CodePageToWide(uint32_t codePage, const char * text, size_t size) noexcept
+{
+    if (codePage != CP_UTF8)
+        return std::wstring();
+
+    std::wstring Wide;
+
+    try
+    {
+        Wide.reserve(size);
+
+        const uint8_t * p = (const uint8_t *) text;
+        const uint8_t * Tail = p + size;
+
+        while (p < Tail)
+        {
+            uint32_t c = *p++;
+
+            if (c < 0x80)
+            {
+                Wide += (wchar_t) c;
+                continue;
+            }
+
+            size_t Count = (c >= 0xF0) ? 3 : (c >= 0xE0) ? 2 : (c >= 0xC0) ? 1 : 0;
+
+            if ((Count == 0) || (c >= 0xF8) || ((size_t) (Tail - p) < Count))
+            {
+                Wide += (wchar_t) 0xFFFD;
+                continue;
+            }
+
+            c &= (0x3Fu >> Count);
+
+            const uint8_t * Head = p;
+
+            for (; Count != 0 && ((*p & 0xC0) == 0x80); --Count)
+                c = (c << 6) | (*p++ & 0x3F);
+
+            if (Count != 0)
+            {
+                Wide += (wchar_t) 0xFFFD;
+                continue;
+            }
+
+            const size_t Length = (size_t) (p - Head);
+
+            // Reject overlong encodings, surrogates and values beyond the Unicode range.
+            if (((Length == 1) && (c < 0x80)) || ((Length == 2) && (c < 0x800)) || ((Length == 3) && (c < 0x10000)) || ((c >= 0xD800) && (c <= 0xDFFF)) || (c > 0x10FFFF))
+                c = 0xFFFD;
+
+            Wide += (wchar_t) c;
+        }
+    }
+    catch (...)
+    {
+        return std::wstring();
+    }
+
+    return Wide;
+}
+#endif
+
 /// <summary>
 /// Converts a string encoded with the specified code page to an UTF-8 string.
 /// </summary>
@@ -73,19 +199,67 @@ std::string CodePageToUTF8(uint32_t codePage, const char * text, size_t size) no
 /// </summary>
 std::string FormatText(const char * format, ...) noexcept
 {
-   va_list vl;
+    va_list vl;
 
-   va_start(vl, format);
+    va_start(vl, format);
 
-    std::string Text;
+    std::string Text = FormatTextV(format, vl);
 
-    Text.resize(256);
+    va_end(vl);
 
-    ::vsprintf_s(Text.data(), Text.size(), format, vl);
+    return Text;
+}
+
+/// <summary>
+/// Formats a string using a format specification and a list of arguments. The text is formatted into a buffer on the stack and only formatted again if it doesn't fit.
+/// </summary>
+std::string FormatTextV(const char * format, va_list args) noexcept
+{
+    char Buffer[256];
+
+    va_list Args;
+
+    va_copy(Args, args);
+
+    const int Size = ::vsnprintf(Buffer, sizeof(Buffer), format, Args);
+
+    va_end(Args);
+
+    if (Size < 0)
+        return std::string();
+
+    try
+    {
+        if ((size_t) Size < sizeof(Buffer))
+            return std::string(Buffer, (size_t) Size);
+
+        std::string Text((size_t) Size, '\0');
+
+        ::vsnprintf(Text.data(), Text.size() + 1, format, args);
+
+        return Text;
+    }
+    catch (...)
+    {
+        return std::string();
+    }
+}
+
+/// <summary>
+/// Formats a string using a format specification and a list of arguments into the specified buffer. The text is truncated if it doesn't fit.
+/// Returns the length of the complete text, which is larger than or equal to the size of the buffer if it was truncated.
+/// </summary>
+size_t FormatTextTo(char * buffer, size_t size, const char * format, ...) noexcept
+{
+    va_list vl;
+
+    va_start(vl, format);
+
+    const int Size = ::vsnprintf(buffer, size, format, vl);
 
     va_end(vl);
 
-    return Text;
+    return (Size > 0) ? (size_t) Size : 0;
 }
 
 /// <summary>
@@ -93,15 +267,11 @@ std::string FormatText(const char * format, ...) noexcept
 /// </summary>
 std::wstring FormatText(const wchar_t * format, ...) noexcept
 {
-   va_list vl;
-
-   va_start(vl, format);
+    va_list vl;
 
-    std::wstring Text;
+    va_start(vl, format);
 
-    Text.resize(256);
-
-    ::vswprintf_s(Text.data(), Text.size(), format, vl);
+    std::wstring Text = FormatTextV(format, vl);
 
     va_end(vl);
 
@@ -109,133 +279,236 @@ std::wstring FormatText(const wchar_t * format, ...) noexcept
 }
 
 /// <summary>
-/// Returns true if the specified text is EUC-JP encoded. (http://www.rikai.com/library/kanjitables/kanji_codes.euc.shtml)
+/// Formats a string using a format specification and a list of arguments. vswprintf() doesn't return the required size so the buffer is enlarged until the text fits.
 /// </summary>
-bool IsEUCJP(const char * text, size_t size) noexcept
+std::wstring FormatTextV(const wchar_t * format, va_list args) noexcept
 {
-    while (size != 0)
+    wchar_t Buffer[256];
+
+    va_list Args;
+
+    va_copy(Args, args);
+
+    int Size = ::vswprintf(Buffer, std::size(Buffer), format, Args);
+
+    va_end(Args);
+
+    if (Size >= 0)
+        return std::wstring(Buffer, (size_t) Size);
+
+    try
     {
-        uint8_t d1 = (uint8_t) *text++;
-        size--;
+        for (size_t BufferSize = std::size(Buffer) * 4; BufferSize <= 16 * 1024 * 1024; BufferSize *= 4)
+        {
+            std::wstring Text(BufferSize, L'\0');
 
-        if (!((d1 >= 0xA1 && d1 <= 0xAD) || (d1 >= 0xB0 && d1 <= 0xFE)))
-            continue;
+            va_copy(Args, args);
 
-        if (size == 0)
-            return false;
+            Size = ::vswprintf(Text.data(), Text.size() + 1, format, Args);
 
-        uint8_t d2 = (uint8_t) *text++;
-        size--;
+            va_end(Args);
 
-        if (!(d2 >= 0xA0 && d1 <= 0xFF))
-            return false;
+            if (Size >= 0)
+            {
+                Text.resize((size_t) Size);
+
+                return Text;
+            }
+        }
+    }
+    catch (...)
+    {
     }
 
-    return true;
+    return std::wstring();
 }
 
 /// <summary>
-/// Returns true if the specified text is Shift-JIS encoded. (http://www.rikai.com/library/kanjitables/kanji_codes.sjis.shtml)
+/// Returns the number of ASCII characters at the start of the text. Checks 32 bytes at a time using SSE2 if available, otherwise 8 bytes at a time.
 /// </summary>
-bool IsShiftJIS(const char * text, size_t size) noexcept
+static size_t SkipASCII(const uint8_t * text, size_t size) noexcept
 {
-    while (size != 0)
+    size_t i = 0;
+
+#if defined(_M_X64) || defined(__SSE2__)
+    for (; i + 32 <= size; i += 32)
     {
-        uint8_t d1 = (uint8_t) *text++;
-        size--;
+        const __m128i a = _mm_loadu_si128((const __m128i *) (text + i));
+        const __m128i b = _mm_loadu_si128((const __m128i *) (text + i + 16));
 
-        if (!((d1 >= 0x81 && d1 <= 0x84) || (d1 >= 0x87 && d1 <= 0x9F) || (d1 >= 0xE0 && d1 <= 0xEF)))
-            continue;
+        if (_mm_movemask_epi8(_mm_or_si128(a, b)) != 0)
+            break;
+    }
+#endif
 
-        if (size == 0)
-            return false;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t Word;
 
-        uint8_t d2 = (uint8_t) *text++;
-        size--;
+        ::memcpy(&Word, text + i, sizeof(Word));
 
-        if (!((d2 >= 0x40 && d2 <= 0x9E) || (d2 >= 0x9F && d2 <= 0xFC)))
-            return false;
+        if ((Word & 0x8080808080808080ull) != 0)
+            break;
     }
 
-    return true;
+    while ((i < size) && (text[i] < 0x80))
+        ++i;
+
+    return i;
 }
 
 /// <summary>
-/// Returns true if the specified text is UTF-8 encoded.
+/// Determines in a single pass which of the supported encodings are valid for the specified text.
+/// Runs of ASCII characters, which are valid in all encodings, are skipped in blocks. The other bytes are checked by a small state machine per encoding.
 /// </summary>
-bool IsUTF8(const char * text, size_t size) noexcept
+text_encodings_t DetectEncodings(const char * text, size_t size) noexcept
 {
-    size_t n = 0;
+    text_encodings_t Result = { true, true, true, true };
+
+    const uint8_t * Data = (const uint8_t *) text;
 
-    for (size_t i = 0; i < size; ++i)
+    // UTF-8: number of continuation bytes still expected and the valid range of the next one. (RFC 3629, excludes overlong forms, surrogates and code points above U+10FFFF)
+    size_t UTF8Remaining = 0;
+    uint8_t UTF8Lo = 0x80, UTF8Hi = 0xBF;
+
+    // Shift-JIS and EUC-JP: true if a trail byte is expected.
+    bool ShiftJISTrail = false;
+    bool EUCJPTrail = false;
+
+    size_t i = 0;
+
+    while (i < size)
     {
-        uint8_t c = (uint8_t ) text[i];
-
-        //if (c==0x09 || c==0x0a || c==0x0d || (0x20 <= c && c <= 0x7e) ) n = 0; // is_printable_ascii
-        if ((0x00 <= c) && (c <= 0x7F))
-            n = 0; // 0bbbbbbb
-        else
-        if ((c & 0xE0) == 0xC0)
-            n = 1; // 110bbbbb
-        else
-        if ((c == 0xED) && (i < (size - 1)) && (((uint8_t) text[i + 1] & 0xA0) == 0xA0))
-            return false; // U+d800 to U+dfff
-
-        if ((c & 0xF0) == 0xE0)
-            n = 2; // 1110bbbb
-        else
-        if ((c & 0xF8) == 0xF0)
-            n = 3; // 11110bbb
-//      else
-//      if ((c & 0xFC) == 0xF8)
-//          n = 4; // 111110bb // byte 5, unnecessary in 4 byte UTF-8
-//      if ((c & 0xFE) == 0xFC)
-//          n = 5; // 1111110b // byte 6, unnecessary in 4 byte UTF-8
-        else
-            return false;
-
-        // Are there n bytes matching 10bbbbbb following?
-        for (size_t j = 0; (j < n) && (i < size); ++j)
-        { 
-            if ((++i == size) || (((uint8_t) text[i] & 0xC0) != 0x80))
-                return false;
+        if ((UTF8Remaining == 0) && !ShiftJISTrail && !EUCJPTrail)
+        {
+            i += SkipASCII(Data + i, size - i);
+
+            if (i == size)
+                break;
         }
+
+        const uint8_t c = Data[i++];
+
+        if (c >= 0x80)
+            Result.IsASCII = false;
+
+        if (Result.IsUTF8)
+        {
+            if (UTF8Remaining != 0)
+            {
+                if ((c < UTF8Lo) || (c > UTF8Hi))
+                    Result.IsUTF8 = false;
+
+                --UTF8Remaining;
+                UTF8Lo = 0x80; UTF8Hi = 0xBF;
+            }
+            else
+            if (c >= 0x80)
+            {
+                if ((c >= 0xC2) && (c <= 0xDF)) { UTF8Remaining = 1; }
+                else
+                if (c == 0xE0)                  { UTF8Remaining = 2; UTF8Lo = 0xA0; }
+                else
+                if (c == 0xED)                  { UTF8Remaining = 2; UTF8Hi = 0x9F; }
+                else
+                if ((c >= 0xE1) && (c <= 0xEF)) { UTF8Remaining = 2; }
+                else
+                if (c == 0xF0)                  { UTF8Remaining = 3; UTF8Lo = 0x90; }
+                else
+                if ((c >= 0xF1) && (c <= 0xF3)) { UTF8Remaining = 3; }
+                else
+                if (c == 0xF4)                  { UTF8Remaining = 3; UTF8Hi = 0x8F; }
+                else
+                    Result.IsUTF8 = false;
+            }
+
+            if (!Result.IsUTF8)
+                UTF8Remaining = 0;
+        }
+
+        // http://www.rikai.com/library/kanjitables/kanji_codes.sjis.shtml
+        if (Result.IsShiftJIS)
+        {
+            if (ShiftJISTrail)
+            {
+                if ((c < 0x40) || (c > 0xFC))
+                    Result.IsShiftJIS = false;
+
+                ShiftJISTrail = false;
+            }
+            else
+                ShiftJISTrail = (c >= 0x81 && c <= 0x84) || (c >= 0x87 && c <= 0x9F) || (c >= 0xE0 && c <= 0xEF);
+        }
+
+        // http://www.rikai.com/library/kanjitables/kanji_codes.euc.shtml
+        if (Result.IsEUCJP)
+        {
+            if (EUCJPTrail)
+            {
+                if (c < 0xA0)
+                    Result.IsEUCJP = false;
+
+                EUCJPTrail = false;
+            }
+            else
+                EUCJPTrail = (c >= 0xA1 && c <= 0xAD) || (c >= 0xB0 && c <= 0xFE);
+        }
+
+        if (!Result.IsUTF8 && !Result.IsShiftJIS && !Result.IsEUCJP)
+            return Result;
     }
 
-    return true;
+    // A multi-byte character must not be truncated.
+    if (UTF8Remaining != 0)
+        Result.IsUTF8 = false;
+
+    if (ShiftJISTrail)
+        Result.IsShiftJIS = false;
+
+    if (EUCJPTrail)
+        Result.IsEUCJP = false;
+
+    return Result;
 }
 
 /// <summary>
-/// Returns true if the specified text is ASCII encoded.
+/// Returns true if the specified text is EUC-JP encoded.
 /// </summary>
-bool IsASCII(const char * text) noexcept
+bool IsEUCJP(const char * text, size_t size) noexcept
 {
-    while (*text)
-    {
-        if (*text < 0)
-            return false;
+    return DetectEncodings(text, size).IsEUCJP;
+}
 
-        ++text;
-    }
+/// <summary>
+/// Returns true if the specified text is Shift-JIS encoded.
+/// </summary>
+bool IsShiftJIS(const char * text, size_t size) noexcept
+{
+    return DetectEncodings(text, size).IsShiftJIS;
+}
 
-    return true;
+/// <summary>
+/// Returns true if the specified text is UTF-8 encoded.
+/// </summary>
+bool IsUTF8(const char * text, size_t size) noexcept
+{
+    return DetectEncodings(text, size).IsUTF8;
 }
 
 /// <summary>
 /// Returns true if the specified text is ASCII encoded.
 /// </summary>
-bool IsASCII(const char * text, size_t size) noexcept
+bool IsASCII(const char * text) noexcept
 {
-    while (size != 0)
-    {
-        if (*text < 0)
-            return false;
-
-        ++text;
-        --size;
-    }
+    return IsASCII(text, ::strlen(text));
+}
 
-    return true;
+/// <summary>
+/// Returns true if the specified text is ASCII encoded.
+/// </summary>
+bool IsASCII(const char * text, size_t size) noexcept
+{
+    return SkipASCII((const uint8_t *) text, size) == size;
 }
 
 /// <summary>
@@ -246,19 +519,18 @@ std::wstring TextToWide(const char * text, size_t size) noexcept
     if (size == 0)
         size = ::strlen(text);
 
-    if (IsASCII(text))
-        return UTF8ToWide(text);
+    const auto Encodings = DetectEncodings(text, size);
 
-    if (IsUTF8(text, size))
-        return UTF8ToWide(text);
+    if (Encodings.IsASCII || Encodings.IsUTF8)
+        return UTF8ToWide(text, size);
 
-    if (IsShiftJIS(text, size))
-        return CodePageToWide(932, text);
+    if (Encodings.IsShiftJIS)
+        return CodePageToWide(932, text, size);
 
-    if (IsEUCJP(text, size))
-        return CodePageToWide(20932, text);
+    if (Encodings.IsEUCJP)
+        return CodePageToWide(20932, text, size);
 
-    return CodePageToWide(51932, text);
+    return CodePageToWide(51932, text, size);
 }
 
 /// <summary>
@@ -269,7 +541,9 @@ std::string TextToUTF8(const char * text, size_t size) noexcept
     if (size == 0)
         size = ::strlen(text);
 
-    if (IsASCII(text, size) || IsUTF8(text, size))
+    const auto Encodings = DetectEncodings(text, size);
+
+    if (Encodings.IsASCII || Encodings.IsUTF8)
     {
         std::string Text;
 
@@ -281,10 +555,10 @@ std::string TextToUTF8(const char * text, size_t size) noexcept
         return Text;
     }
 
-    if (IsShiftJIS(text, size))
+    if (Encodings.IsShiftJIS)
         return CodePageToUTF8(932, text, size);
 
-    if (IsEUCJP(text, size))
+    if (Encodings.IsEUCJP)
         return CodePageToUTF8(20932, text, size);
 
     return CodePageToUTF8(51932, text, size);
@@ -320,12 +594,12 @@ const uint8_t Data1[] =
     0x69, 0x6e, 0x67, 0x6c, 0x65, 0x20, 0x65, 0x64, 0x69, 0x74, 0x2d, 0x20, 0x5d, 0x20, 0x66, 0x6f, 0x72, 0x20, 0x53, 0x43, 0x2d, 0x38, 0x38, 0x50,
     0x72, 0x6f, 0x20, 0x32, 0x50, 0x6f, 0x72, 0x74, 0x20, 0x76, 0x65, 0x72, 0x37, 0x2e, 0x30, 0x20, 0x62, 0x79, 0x20, 0x4c, 0x69, 0x78, 0x00
 };
-const WCHAR * Text1 = L"Final Fantasy 5 [ ビッグブリッヂの死闘 ’９９ -single edit- ] for SC-88Pro 2Port ver7.0 by Lix";
+const wchar_t * Text1 = L"Final Fantasy 5 [ ビッグブリッヂの死闘 ’９９ -single edit- ] for SC-88Pro 2Port ver7.0 by Lix";
 
 struct Test
 {
     const uint8_t * Data;
-    const WCHAR * Text;
+    const wchar_t * Text;
 } Tests[] =
 {
     { Data1, Text1 },   // Mixed ASCII and Shift-JIS
@@ -1,11 +1,23 @@
 
-/** $VER: Stream.cpp (2025.08.17) P. Stuer **/
+/** $VER: Stream.cpp (2026.10.19) P. Stuer **/
 
 #include "pch.h"
 
+#ifndef _WIN32
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace msc
 {
 
+#ifdef _WIN32
+
 /// <summary>
 /// Opens the stream.
 /// </summary>
@@ -15,10 +27,10 @@ bool file_stream_t::Open(const fs::path & filePath, bool forWriting)
     const DWORD CreationDisposition = (DWORD) (forWriting ? CREATE_ALWAYS : OPEN_EXISTING);
     const DWORD FlagsAndAttributes = (DWORD) (FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN);
 
-    _hFile = ::CreateFileW(UTF8ToWide(filePath.string().c_str()).c_str(), DesiredAccess, FILE_SHARE_READ, nullptr, CreationDisposition, FlagsAndAttributes, 0);
+    _hFile = ::CreateFileW(filePath.c_str(), DesiredAccess, FILE_SHARE_READ, nullptr, CreationDisposition, FlagsAndAttributes, 0);
 
     if (_hFile == INVALID_HANDLE_VALUE)
-        throw win32_exception(FormatText("Failed to open file \"%s\" for %s", filePath.c_str(), (forWriting ? "writing" : "reading")));
+        throw win32_exception(FormatText("Failed to open file \"%s\" for %s", WideToUTF8(filePath.native()).c_str(), (forWriting ? "writing" : "reading")));
 
     return true;
 }
@@ -105,15 +117,28 @@ void file_stream_t::Offset(uint64_t size)
         throw win32_exception(FormatText("Failed to move to offset %llu", size));
 }
 
+/// <summary>
+/// Gets the size of the stream.
+/// </summary>
+uint64_t file_stream_t::Size() const
+{
+    LARGE_INTEGER li = { };
+
+    if (!::GetFileSizeEx(_hFile, &li))
+        throw win32_exception("Failed to get file size");
+
+    return (uint64_t) li.QuadPart;
+}
+
 /// <summary>
 /// Opens the stream.
 /// </summary>
 bool memory_stream_t::Open(const fs::path & filePath, uint64_t offset, uint64_t size, bool forWriting)
 {
-    _hFile = ::CreateFileW(filePath.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    _hFile = ::CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
 
     if (_hFile == INVALID_HANDLE_VALUE)
-        throw win32_exception(FormatText("Failed to open file \"%s\" for reading", filePath.c_str()));
+        throw win32_exception(FormatText("Failed to open file \"%s\" for reading", WideToUTF8(filePath.native()).c_str()));
 
     _hMap = ::CreateFileMappingW(_hFile, NULL, PAGE_READONLY, 0, 0, NULL);
 
@@ -131,31 +156,31 @@ bool memory_stream_t::Open(const fs::path & filePath, uint64_t offset, uint64_t
             throw win32_exception("Failed to map view of file");
     }
 
-    if (size == 0)
+    uint64_t FileSize = 0;
+
     {
         LARGE_INTEGER li = { };
 
         if (!::GetFileSizeEx(_hFile, &li))
             throw win32_exception("Failed to get file size");
 
-        size = (uint64_t) li.QuadPart;
+        FileSize = (uint64_t) li.QuadPart;
     }
 
+    if (size == 0)
+        size = FileSize - offset;
+
     _Curr = _Data;
     _Tail = _Data + size;
 
-    return true;
-}
+    // The system fills the rest of the last page of a view with zeros. The byte following the data is part of that page if the view ends at the end of the file, and the file does not end on a page boundary.
+    {
+        SYSTEM_INFO si = { };
 
-/// <summary>
-/// Opens the stream.
-/// </summary>
-bool memory_stream_t::Open(const uint8_t * data, uint64_t size)
-{
-    _Data = (uint8_t *) data;
+        ::GetSystemInfo(&si);
 
-    _Curr = _Data;
-    _Tail = _Data + size;
+        _IsZeroTerminated = (offset + size == FileSize) && (((uintptr_t) _Tail % si.dwPageSize) != 0);
+    }
 
     return true;
 }
@@ -182,6 +207,243 @@ void memory_stream_t::Close() noexcept
         ::CloseHandle(_hFile);
         _hFile = INVALID_HANDLE_VALUE;
     }
+
+    _Data = _Curr = _Tail = nullptr;
+    _MapSize = 0;
+    _IsZeroTerminated = false;
+}
+
+#else
+
+/// <summary>
+/// Formats a message with the description of the last error.
+/// </summary>
+static std::string GetErrorMessage(const std::string & errorMessage)
+{
+    const int ErrorCode = errno;
+
+    return FormatText("%s: %s (%d)", errorMessage.c_str(), ::strerror(ErrorCode), ErrorCode);
+}
+
+/// <summary>
+/// Opens the stream.
+/// </summary>
+bool file_stream_t::Open(const fs::path & filePath, bool forWriting)
+{
+    const int Flags = forWriting ? (O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC) : (O_RDONLY | O_CLOEXEC);
+
+    _hFile = ::open(filePath.c_str(), Flags, 0644);
+
+    if (_hFile == InvalidNativeHandle)
+        throw exception(GetErrorMessage(FormatText("Failed to open file \"%s\" for %s", filePath.c_str(), (forWriting ? "writing" : "reading"))));
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (!forWriting)
+        (void) ::posix_fadvise(_hFile, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    _Offset = 0;
+
+    return true;
+}
+
+/// <summary>
+/// Closes the stream.
+/// </summary>
+void file_stream_t::Close() noexcept
+{
+    if (_hFile != InvalidNativeHandle)
+    {
+        ::close(_hFile);
+        _hFile = InvalidNativeHandle;
+    }
+}
+
+/// <summary>
+/// Reads a number of bytes.
+/// </summary>
+void file_stream_t::Read(void * data, uint64_t size)
+{
+    uint64_t BytesRead = 0;
+
+    while (BytesRead < size)
+    {
+        const ssize_t Result = ::pread(_hFile, (uint8_t *) data + BytesRead, (size_t) (size - BytesRead), (off_t) (_Offset + BytesRead));
+
+        if (Result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            throw exception(GetErrorMessage(FormatText("Failed to read %llu bytes", size)));
+        }
+
+        if (Result == 0)
+            throw exception(FormatText("Failed to read %llu bytes, got %llu bytes", size, BytesRead));
+
+        BytesRead += (uint64_t) Result;
+    }
+
+    _Offset += size;
+}
+
+/// <summary>
+/// Writes a number of bytes.
+/// </summary>
+void file_stream_t::Write(const void * data, uint64_t size)
+{
+    uint64_t BytesWritten = 0;
+
+    while (BytesWritten < size)
+    {
+        const ssize_t Result = ::pwrite(_hFile, (const uint8_t *) data + BytesWritten, (size_t) (size - BytesWritten), (off_t) (_Offset + BytesWritten));
+
+        if (Result < 0)
+        {
+            if (errno == EINTR)
+                continue;
+
+            throw exception(GetErrorMessage(FormatText("Failed to write %llu bytes", size)));
+        }
+
+        BytesWritten += (uint64_t) Result;
+    }
+
+    _Offset += size;
+}
+
+/// <summary>
+/// Skips the specified number of bytes.
+/// </summary>
+void file_stream_t::Skip(uint64_t size)
+{
+    _Offset += size;
+}
+
+/// <summary>
+/// Gets the current offset.
+/// </summary>
+uint64_t file_stream_t::Offset() const
+{
+    return _Offset;
+}
+
+/// <summary>
+/// Moves to the specified offset.
+/// </summary>
+void file_stream_t::Offset(uint64_t size)
+{
+    _Offset = size;
+}
+
+/// <summary>
+/// Gets the size of the stream.
+/// </summary>
+uint64_t file_stream_t::Size() const
+{
+    struct stat Stat = { };
+
+    if (::fstat(_hFile, &Stat) != 0)
+        throw exception(GetErrorMessage("Failed to get file size"));
+
+    return (uint64_t) Stat.st_size;
+}
+
+/// <summary>
+/// Opens the stream.
+/// </summary>
+bool memory_stream_t::Open(const fs::path & filePath, uint64_t offset, uint64_t size, bool)
+{
+    _hFile = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+
+    if (_hFile == InvalidNativeHandle)
+        throw exception(GetErrorMessage(FormatText("Failed to open file \"%s\" for reading", filePath.c_str())));
+
+    struct stat Stat = { };
+
+    if (::fstat(_hFile, &Stat) != 0)
+        throw exception(GetErrorMessage("Failed to get file size"));
+
+    const uint64_t FileSize = (uint64_t) Stat.st_size;
+
+    if (size == 0)
+        size = FileSize - offset;
+
+    if ((offset > FileSize) || (size > FileSize - offset) || (size == 0))
+        throw exception("Failed to map view of file: invalid range");
+
+    // The offset of a mapping must be a multiple of the page size.
+    const uint64_t PageSize = (uint64_t) ::sysconf(_SC_PAGESIZE);
+    const uint64_t MapOffset = offset - (offset % PageSize);
+
+    _MapSize = (size_t) (size + (offset - MapOffset));
+
+    _hMap = ::mmap(nullptr, _MapSize, PROT_READ, MAP_SHARED, _hFile, (off_t) MapOffset);
+
+    if (_hMap == MAP_FAILED)
+    {
+        _hMap = nullptr;
+
+        throw exception(GetErrorMessage("Failed to map view of file"));
+    }
+
+    // The stream is usually read from front to back.
+    (void) ::madvise(_hMap, _MapSize, MADV_SEQUENTIAL);
+    (void) ::madvise(_hMap, _MapSize, MADV_WILLNEED);
+
+#ifdef MADV_HUGEPAGE
+    if (_MapSize >= 2 * 1024 * 1024)
+        (void) ::madvise(_hMap, _MapSize, MADV_HUGEPAGE);
+#endif
+
+    _Data = (uint8_t *) _hMap + (offset - MapOffset);
+
+    _Curr = _Data;
+    _Tail = _Data + size;
+
+    // The system fills the rest of the last page of a mapping with zeros. The byte following the data is part of that page if the view ends at the end of the file, and the file does not end on a page boundary.
+    _IsZeroTerminated = (offset + size == FileSize) && (((uintptr_t) _Tail % PageSize) != 0);
+
+    return true;
+}
+
+/// <summary>
+/// Closes the stream.
+/// </summary>
+void memory_stream_t::Close() noexcept
+{
+    if (_hMap)
+    {
+        ::munmap(_hMap, _MapSize);
+        _hMap = nullptr;
+    }
+
+    if (_hFile != InvalidNativeHandle)
+    {
+        ::close(_hFile);
+        _hFile = InvalidNativeHandle;
+    }
+
+    _Data = _Curr = _Tail = nullptr;
+    _MapSize = 0;
+    _IsZeroTerminated = false;
+}
+
+#endif
+
+/// <summary>
+/// Opens the stream.
+/// </summary>
+bool memory_stream_t::Open(const uint8_t * data, uint64_t size)
+{
+    _Data = (uint8_t *) data;
+
+    _Curr = _Data;
+    _Tail = _Data + size;
+
+    _IsZeroTerminated = false;
+
+    return true;
 }
 
 }
@@ -1,8 +1,9 @@
 
-/** $VER: pch.h (2025.09.01) P. Stuer **/
+/** $VER: pch.h (2026.10.19) P. Stuer **/
 
 #pragma once
 
+#ifdef _WIN32
 #include <CppCoreCheck/Warnings.h>
 
 #pragma warning(disable: 4100 4625 4626 4710 4711 4738 5045 ALL_CPPCORECHECK_WARNINGS)
@@ -15,8 +16,10 @@
 #include <windows.h>
 #include <wincodec.h>
 
-#include <stdlib.h>
 #include <strsafe.h>
+#endif
+
+#include <stdlib.h>
 #include <stdarg.h>
 
 #include <algorithm>
@@ -29,7 +32,7 @@
 #include "libmsc.h"
 
 #ifndef Assert
-#if defined(DEBUG) || defined(_DEBUG)
+#if defined(_WIN32) && (defined(DEBUG) || defined(_DEBUG))
 #define Assert(b) do {if (!(b)) { ::OutputDebugStringA("Assert: " #b "\n");}} while(0)
 #else
 #define Assert(b)
@@ -39,7 +42,7 @@
 #define TOSTRING_IMPL(x) #x
 #define TOSTRING(x) TOSTRING_IMPL(x)
 
-#ifndef THIS_HINSTANCE
+#if defined(_WIN32) && !defined(THIS_HINSTANCE)
 EXTERN_C IMAGE_DOS_HEADER __ImageBase;
 #define THIS_HINSTANCE ((HINSTANCE) &__ImageBase)
 #endif
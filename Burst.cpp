@@ -0,0 +1,279 @@
+
+/** $VER: Burst.cpp (2026.10.19) P. Stuer - Tone bursts, impulse trains and click trains **/
+
+#include "pch.h"
+
+#include "Burst.h"
+#include "SignalDocument.h"
+
+#include <numbers>
+
+#pragma hdrstop
+
+static_assert(sizeof(audio_sample) == sizeof(double), "sizeof(audio_sample) != sizeof(double)");
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+burst_t::burst_t(const signal_document_t & document) : native_generator_t(document), _Interval(), _Offset(), _Count(), _Block(BlockSize), _Position()
+{
+    const std::string Name = document.GetString("generator");
+
+    CreateTemplate(document, Name);
+
+    const uint64_t TemplateSize = _Template.size();
+
+    std::vector<double> Positions = document.GetDoubles("positions");
+
+    if (Positions.empty())
+    {
+        for (const double Time : document.GetDoubles("times"))
+            Positions.push_back(std::round(Time * _SampleRate));
+    }
+
+    uint64_t LastFrame = 0; // Frame after the last event, 0 if endless.
+
+    if (!Positions.empty())
+    {
+        std::vector<double> Amplitudes = document.GetDoubles("amplitudes");
+
+        if (!Amplitudes.empty() && (Amplitudes.size() != Positions.size()))
+            throw exception_io_data("Number of amplitudes does not match the number of events");
+
+        for (size_t i = 0; i < Positions.size(); ++i)
+        {
+            if ((Positions[i] < 0.) || (Positions[i] != std::floor(Positions[i])))
+                throw exception_io_data(msc::FormatText("Invalid event position %g", Positions[i]).c_str());
+
+            _Events.push_back({ (uint64_t) Positions[i], Amplitudes.empty() ? 1. : Amplitudes[i] });
+        }
+
+        std::stable_sort(_Events.begin(), _Events.end(), [](const event_t & a, const event_t & b) { return a.Position < b.Position; });
+
+        LastFrame = _Events.back().Position + TemplateSize;
+    }
+    else
+    {
+        _Interval = document.Has("period") ? (uint64_t) document.GetInteger("period", 0, 1, INT64_MAX) : (uint64_t) std::llround(document.GetDouble("interval", 1., 1. / _SampleRate, 86400.) * _SampleRate);
+        _Offset   = (uint64_t) document.GetInteger("offset", 0, 0, INT64_MAX);
+        _Count    = (uint64_t) document.GetInteger("count", 0, 0, INT64_MAX);
+
+        if (_Count != 0)
+            LastFrame = _Offset + (_Count - 1) * _Interval + TemplateSize;
+        else
+        if (_Interval <= MaxPeriodSize)
+        {
+            // An endless train is the same in every period. Add the events that overlap each period once.
+            _Period.assign(_Interval, 0.);
+
+            for (uint64_t i = 0; i < TemplateSize; ++i)
+                _Period[(_Offset + i) % _Interval] += _Template[i];
+        }
+    }
+
+    if (!document.Has("duration"))
+        _FrameCount = LastFrame;
+}
+
+/// <summary>
+/// Returns true if the specified name identifies one of the signals of this generator.
+/// </summary>
+bool burst_t::IsOurGenerator(const std::string & name) noexcept
+{
+    return msc::IsOneOf(name.c_str(), { "tone-burst", "impulse-train", "click-train" });
+}
+
+/// <summary>
+/// Adds generator specific info tags.
+/// </summary>
+void burst_t::GetInfo(file_info & fileInfo) const noexcept
+{
+    fileInfo.info_set_int("fis_event_size", (int64_t) _Template.size());
+
+    if (_Events.empty())
+        fileInfo.info_set_int("fis_event_interval", (int64_t) _Interval);
+    else
+        fileInfo.info_set_int("fis_event_count", (int64_t) _Events.size());
+}
+
+/// <summary>
+/// Generates the specified number of interleaved frames at the current position.
+/// </summary>
+void burst_t::Generate(audio_sample * data, size_t frameCount) noexcept
+{
+    double * Block = _Block.data();
+
+    while (frameCount != 0)
+    {
+        const size_t n = std::min(frameCount, BlockSize);
+
+        // The period contains the tails of the events before the offset so it is only used once the first event has ended.
+        if (!_Period.empty() && (_Position >= _Offset + _Template.size()))
+            RenderPeriod(Block, n);
+        else
+        {
+            std::fill(Block, Block + n, 0.);
+
+            if (_Events.empty())
+                RenderPeriodicEvents(Block, n);
+            else
+                RenderEvents(Block, n);
+        }
+
+        if (_ChannelCount == 1)
+            ::memcpy(data, Block, n * sizeof(*data));
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                for (uint32_t j = 0; j < _ChannelCount; ++j)
+                    data[i * _ChannelCount + j] = Block[i];
+        }
+
+        data += n * _ChannelCount;
+
+        _Position += n;
+        frameCount -= n;
+    }
+}
+
+/// <summary>
+/// Creates the waveform of a single event.
+/// </summary>
+void burst_t::CreateTemplate(const signal_document_t & document, const std::string & name)
+{
+    const double SampleRate = (double) _SampleRate;
+
+    if (msc::IsOneOf(name.c_str(), { "impulse-train" }))
+    {
+        _Template.assign(1, _Level);
+    }
+    else
+    if (msc::IsOneOf(name.c_str(), { "click-train" }))
+    {
+        // A positive Hann pulse.
+        const size_t Size = std::max((size_t) std::llround(document.GetDouble("width", 1., 0., 1000.) / 1000. * SampleRate), (size_t) 1);
+
+        _Template.resize(Size);
+
+        for (size_t i = 0; i < Size; ++i)
+            _Template[i] = _Level * (0.5 - 0.5 * std::cos(2. * std::numbers::pi * ((double) i + .5) / (double) Size));
+    }
+    else
+    {
+        const double Frequency = document.GetDouble("frequency", 1000., 1., SampleRate / 2.);
+        const double Cycles    = document.GetDouble("cycles", 10., 0.5, 100000.);
+
+        const size_t Size = std::max((size_t) std::llround(Cycles * SampleRate / Frequency), (size_t) 2);
+
+        const std::string Window = document.GetString("window", "hann");
+
+        const bool IsHann     = msc::IsOneOf(Window.c_str(), { "hann" });
+        const bool IsBlackman = msc::IsOneOf(Window.c_str(), { "blackman" });
+
+        if (!IsHann && !IsBlackman && !msc::IsOneOf(Window.c_str(), { "rectangular" }))
+            throw exception_io_data(msc::FormatText("Unknown window \"%s\"", Window.c_str()).c_str());
+
+        _Template.resize(Size);
+
+        for (size_t i = 0; i < Size; ++i)
+        {
+            const double x = (double) i / (double) (Size - 1);
+
+            double w = 1.;
+
+            if (IsHann)
+                w = 0.5 - 0.5 * std::cos(2. * std::numbers::pi * x);
+            else
+            if (IsBlackman)
+                w = 0.42 - 0.5 * std::cos(2. * std::numbers::pi * x) + 0.08 * std::cos(4. * std::numbers::pi * x);
+
+            _Template[i] = _Level * w * std::sin(2. * std::numbers::pi * Frequency * (double) i / SampleRate);
+        }
+    }
+}
+
+/// <summary>
+/// Renders an endless periodic train by copying the precalculated period. The cost does not depend on the number of events.
+/// Only valid after the end of the first event.
+/// </summary>
+void burst_t::RenderPeriod(double * block, size_t frameCount) const noexcept
+{
+    const size_t PeriodSize = _Period.size();
+
+    size_t Offset = (size_t) (_Position % PeriodSize);
+
+    while (frameCount != 0)
+    {
+        const size_t n = std::min(frameCount, PeriodSize - Offset);
+
+        ::memcpy(block, _Period.data() + Offset, n * sizeof(*block));
+
+        block += n;
+        frameCount -= n;
+        Offset = 0;
+    }
+}
+
+/// <summary>
+/// Renders the events of a periodic train that overlap the block. The first event is calculated directly from the position.
+/// </summary>
+void burst_t::RenderPeriodicEvents(double * block, size_t frameCount) const noexcept
+{
+    const int64_t Start    = (int64_t) _Position;
+    const int64_t Interval = (int64_t) _Interval;
+    const int64_t Offset   = (int64_t) _Offset;
+
+    // Events k with Start - TemplateSize < Offset + k * Interval < Start + frameCount.
+    const int64_t Low  = Start - (int64_t) _Template.size() + 1 - Offset;
+    const int64_t High = Start + (int64_t) frameCount - 1 - Offset;
+
+    int64_t First = (Low >= 0) ? (Low + Interval - 1) / Interval : -((-Low) / Interval);
+    int64_t Last  = (High >= 0) ? High / Interval : -((-High + Interval - 1) / Interval);
+
+    // Nothing plays before the offset.
+    First = std::max(First, (int64_t) 0);
+
+    if (_Count != 0)
+        Last = std::min(Last, (int64_t) _Count - 1);
+
+    for (int64_t k = First; k <= Last; ++k)
+        AddEvent(block, frameCount, Offset + k * Interval, 1.);
+}
+
+/// <summary>
+/// Renders the explicit events that overlap the block. The first event is found with a binary search.
+/// </summary>
+void burst_t::RenderEvents(double * block, size_t frameCount) const noexcept
+{
+    const uint64_t Start = _Position;
+    const uint64_t End   = _Position + frameCount;
+    const uint64_t Low   = (Start >= _Template.size()) ? Start - _Template.size() + 1 : 0;
+
+    auto Event = std::lower_bound(_Events.begin(), _Events.end(), Low, [](const event_t & e, uint64_t position) { return e.Position < position; });
+
+    for (; (Event != _Events.end()) && (Event->Position < End); ++Event)
+        AddEvent(block, frameCount, (int64_t) Event->Position, Event->Amplitude);
+}
+
+/// <summary>
+/// Adds the part of an event that overlaps the block.
+/// </summary>
+void burst_t::AddEvent(double * block, size_t frameCount, int64_t position, double amplitude) const noexcept
+{
+    const int64_t Start = (int64_t) _Position;
+
+    // Index of the first template sample and the first block sample.
+    const size_t Src = (position < Start) ? (size_t) (Start - position) : 0;
+    const size_t Dst = (position > Start) ? (size_t) (position - Start) : 0;
+
+    if ((Src >= _Template.size()) || (Dst >= frameCount))
+        return;
+
+    const size_t n = std::min(_Template.size() - Src, frameCount - Dst);
+
+    const double * __restrict s = _Template.data() + Src;
+    double * __restrict d = block + Dst;
+
+    for (size_t i = 0; i < n; ++i)
+        d[i] += amplitude * s[i];
+}
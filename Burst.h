@@ -0,0 +1,60 @@
+
+/** $VER: Burst.h (2026.10.19) P. Stuer - Tone bursts, impulse trains and click trains **/
+
+#pragma once
+
+#include "Generator.h"
+
+#include <vector>
+
+/// <summary>
+/// Generates windowed tone bursts, diracs and clicks at exact sample positions.
+/// The waveform of one event is calculated once. A periodic, endless train is calculated once as a single period so rendering is a copy,
+/// all other events are added to the output with a multiply-add of the precalculated waveform.
+/// </summary>
+class burst_t : public native_generator_t
+{
+public:
+    burst_t(const signal_document_t & document);
+
+    static bool IsOurGenerator(const std::string & name) noexcept;
+
+    void GetInfo(file_info & fileInfo) const noexcept override;
+
+protected:
+    void Generate(audio_sample * data, size_t frameCount) noexcept override;
+
+    void SetPosition(uint64_t frameIndex) noexcept override
+    {
+        _Position = frameIndex;
+    }
+
+private:
+    struct event_t
+    {
+        uint64_t Position;  // Frame index of the first sample of the event
+        double Amplitude;
+    };
+
+    void CreateTemplate(const signal_document_t & document, const std::string & name);
+
+    void RenderPeriod(double * block, size_t frameCount) const noexcept;
+    void RenderPeriodicEvents(double * block, size_t frameCount) const noexcept;
+    void RenderEvents(double * block, size_t frameCount) const noexcept;
+    void AddEvent(double * block, size_t frameCount, int64_t position, double amplitude) const noexcept;
+
+private:
+    std::vector<double> _Template;  // Waveform of a single event
+    std::vector<double> _Period;    // One period of an endless periodic train, with all overlapping events added. Empty if not used.
+    std::vector<event_t> _Events;   // Explicit events, sorted by position. Empty for a periodic train.
+
+    uint64_t _Interval;             // Number of frames between two events of a periodic train
+    uint64_t _Offset;               // Frame index of the first event of a periodic train
+    uint64_t _Count;                // Number of events of a periodic train, 0 if endless
+
+    std::vector<double> _Block;
+    uint64_t _Position;
+
+    static const size_t BlockSize = 1024;
+    static const uint64_t MaxPeriodSize = 1 << 22; // Longer periods are rendered event by event.
+};
@@ -4,14 +4,21 @@
 #include "pch.h"
 
 #include "CSound.h"
+#include "Configuration.h"
+#include "HostOpcodes.h"
 
 #include "Resources.h"
 #include "Log.h"
 
+#include <chrono>
+#include <mutex>
+
+static void Initialize();
+
 /// <summary>
 /// Initializes this instance.
 /// </summary>
-csound_t::csound_t() noexcept : _SampleRate(), _ControlRate(), _ChannelCount(), _SrcData()
+csound_t::csound_t() noexcept : _ControlRate(), _0dBFSLevel(), _FramesPerControlCycle(), _SamplesPerControlCycle(), _FramesPerChunk(), _SrcData(), _MIDIIndex(), _Duration(), _SubsongIndex(), _IsStarted(), _FrameIndex(), _IsAttached(), _StatisticsFrameIndex()
 {
     static_assert(sizeof(audio_sample) == sizeof(MYFLT), "sizeof(audio_sample) != sizeof(MYFLT)");
 
@@ -41,19 +48,121 @@ csound_t::csound_t() noexcept : _SampleRate(), _ControlRate(), _ChannelCount(),
                 This->_Line += c;
         }
     });
+
+    // Report the files that Csound opens itself.
+    ::csoundSetFileOpenCallback(_CSound.GetCsound(), [](CSOUND *, const char * filePath, int, int isWriting, int isTemporary)
+    {
+        if (!isWriting && !isTemporary)
+            Log.AtDebug().Write(STR_COMPONENT_NAME " Csound opens \"%s\".", filePath);
+    });
+
+    RegisterHostOpcodes(_CSound.GetCsound());
+}
+
+/// <summary>
+/// Destroys this instance.
+/// </summary>
+csound_t::~csound_t()
+{
+    DetachChannels();
+}
+
+/// <summary>
+/// Loads the Csound library and initializes it. The library is delay-loaded so foobar2000 doesn't load Csound and its dependencies at startup, only when the first document is played.
+/// </summary>
+static void Initialize()
+{
+    static std::once_flag Flag;
+    static bool IsAvailable = false;
+
+    std::call_once(Flag, []()
+    {
+        const auto StartTime = std::chrono::steady_clock::now();
+
+        // Prefer the copy in the component directory. Its dependencies are searched in the same directory.
+        const char * ComponentPath = core_api::get_my_full_path();
+
+        const fs::path LibraryPath = fs::path(msc::UTF8ToWide(ComponentPath, ::strlen(ComponentPath))).parent_path() / L"csound64.dll";
+
+        HMODULE hModule = ::LoadLibraryExW(LibraryPath.c_str(), NULL, LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR | LOAD_LIBRARY_SEARCH_DEFAULT_DIRS);
+
+        if (hModule == NULL)
+            hModule = ::LoadLibraryW(L"csound64.dll"); // An installed Csound on the search path.
+
+        if (hModule == NULL)
+        {
+            Log.AtError().Write(STR_COMPONENT_NAME " failed to load csound64.dll (0x%08X).", ::GetLastError());
+            return;
+        }
+
+        // foobar2000 handles the signals and the shutdown.
+        if (::csoundInitialize(CSOUNDINIT_NO_SIGNAL_HANDLER | CSOUNDINIT_NO_ATEXIT) < 0)
+        {
+            Log.AtError().Write(STR_COMPONENT_NAME " failed to initialize Csound.");
+            return;
+        }
+
+        IsAvailable = true;
+
+        const auto Duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime);
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " loaded Csound in %.1f ms.", Duration.count());
+    });
+
+    if (!IsAvailable)
+        throw exception_io("Csound is not available");
 }
 
 /// <summary>
-/// Loads and compiles a CSD file.
+/// Creates a new instance. Csound loads the opcode plugins from the configured directory.
 /// </summary>
-void csound_t::Load(const std::string & content)
+std::unique_ptr<csound_t> csound_t::Create()
+{
+    Initialize();
+
+    // Csound keeps a pointer to the directory name instead of a copy. The lock keeps it stable while another thread creates an instance.
+    static msc::critical_section_t Lock;
+    static std::string OpcodeDirectory;
+
+    Lock.Enter();
+
+    {
+        pfc::string8 Directory;
+
+        CfgOpcodeDirectory.get(Directory);
+
+        OpcodeDirectory = Directory.c_str();
+    }
+
+    ::csoundSetOpcodedir(!OpcodeDirectory.empty() ? OpcodeDirectory.c_str() : nullptr);
+
+    const auto StartTime = std::chrono::steady_clock::now();
+
+    auto CSound = std::make_unique<csound_t>();
+
+    const auto Duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime);
+
+    Lock.Leave();
+
+    Log.AtDebug().Write(STR_COMPONENT_NAME " created a Csound instance in %.1f ms (opcode directory \"%s\").", Duration.count(), OpcodeDirectory.empty() ? "default" : OpcodeDirectory.c_str());
+
+    return CSound;
+}
+
+/// <summary>
+/// Loads and compiles a CSD file. The text must be zero-terminated. It is not needed anymore after this method returns.
+/// </summary>
+void csound_t::Load(const char * text)
 {
     int Result = _CSound.SetOption("-o null");      // Override the output option in the CSD.
 
     if (Result != CSOUND_SUCCESS)
         throw exception_io("Failed to set Csound option");
 
-    Result = _CSound.CompileCSD(content.c_str(), 1, 0);
+    if (_MIDIFile)
+        SetMIDICallbacks();
+
+    Result = _CSound.CompileCSD(text, 1, 0);
 
     if (Result != CSOUND_SUCCESS)
         throw exception_io("Failed to compile Csound Document");
@@ -68,27 +177,98 @@ void csound_t::Load(const std::string & content)
 
     // Make sure the audio chunk is large enough to hold all samples of a control cycle.
     _FramesPerChunk = ((512 + _FramesPerControlCycle - 1) / _FramesPerControlCycle) * _FramesPerControlCycle;
+
+    if (_MIDIFile)
+        _FrameCount = (uint64_t) (_Duration * _SampleRate + .5);
 }
 
 /// <summary>
-/// Starts rendering.
+/// Starts rendering. The orchestra is only started once. Later starts rewind the score and play the selected subsong.
 /// </summary>
-void csound_t::Start() noexcept
+void csound_t::Start()
 {
-    _CSound.Start();
+    CSOUND * CSound = _CSound.GetCsound();
+
+    // Only an instance that renders receives channel updates.
+    if (!_IsAttached)
+    {
+        channel_server_t::Attach(&_ChannelQueue);
+
+        _IsAttached = true;
+    }
+
+    const subsong_t * Subsong = !_Subsongs.empty() ? &_Subsongs[std::min((size_t) _SubsongIndex, _Subsongs.size() - 1)] : nullptr;
+
+    // Skip to the start of the score section.
+    if ((Subsong != nullptr) && Subsong->Instrument.empty())
+        ::csoundSetScoreOffsetSeconds(CSound, Subsong->Offset);
+
+    if (!_IsStarted)
+    {
+        _CSound.Start();
+
+        _IsStarted = true;
+    }
+    else
+        ::csoundRewindScore(CSound); // Also turns off all active notes.
+
+    if (Subsong != nullptr)
+    {
+        if (Subsong->Instrument.empty())
+            _FrameCount = (uint64_t) (Subsong->Duration * _SampleRate + .5);
+        else
+            ::csoundEventString(CSound, msc::FormatText("i \"%s\" 0 -1", Subsong->Instrument.c_str()).c_str(), 0);
+    }
+
+    if (_MIDIFile)
+        _MIDIIndex = _MIDIFile->Find(0.);
+
+    if (_Score)
+    {
+        _Score->Rewind();
+        _Score->Feed(CSound, 0.);
+    }
+
+    _FrameIndex = 0;
+
+    _Statistics.Reset(_SamplesPerControlCycle, _ChannelCount);
+    _StatisticsFrameIndex = 0;
 
     _SrcData = _CSound.GetSpout();
 }
 
+/// <summary>
+/// Gets the number of frames of the specified subsong, 0 if infinite.
+/// </summary>
+uint64_t csound_t::GetFrameCount(uint32_t subsongIndex) const noexcept
+{
+    if (subsongIndex >= _Subsongs.size())
+        return _FrameCount;
+
+    return (uint64_t) (_Subsongs[subsongIndex].Duration * _SampleRate + .5);
+}
+
+/// <summary>
+/// Gets the name of the specified subsong.
+/// </summary>
+std::string csound_t::GetSubsongName(uint32_t subsongIndex) const
+{
+    return (subsongIndex < _Subsongs.size()) ? _Subsongs[subsongIndex].Name : std::string();
+}
+
 /// <summary>
 /// Stops rendering.
 /// </summary>
 void csound_t::Stop() noexcept
 {
+    DetachChannels();
+
     _SrcData = nullptr;
 
     _CSound.Reset();
 
+    _IsStarted = false;
+
     if (!_Line.empty())
     {
         Log.AtInfo().Write("Csound: %s", _Line.c_str());
@@ -96,6 +276,156 @@ void csound_t::Stop() noexcept
     }
 }
 
+/// <summary>
+/// Adds generator specific info tags.
+/// </summary>
+void csound_t::GetInfo(file_info & fileInfo) const noexcept
+{
+    fileInfo.info_set_int("fis_control_rate", _ControlRate);
+    fileInfo.info_set_int("fis_channel_count", _ChannelCount);
+    fileInfo.info_set_int("fis_0dbfs_level", (int64_t) _0dBFSLevel);
+
+    if (_Score && (_Score->GetEventCount() != 0))
+        fileInfo.info_set_int("fis_streamed_events", (int64_t) _Score->GetEventCount());
+}
+
+/// <summary>
+/// Adds the statistics of the generated signal. They are updated once per second.
+/// </summary>
+bool csound_t::GetDynamicInfo(file_info & fileInfo) noexcept
+{
+    if ((_FrameIndex == 0) || (_FrameIndex < _StatisticsFrameIndex + _SampleRate))
+        return false;
+
+    _StatisticsFrameIndex = _FrameIndex;
+
+    try
+    {
+        std::string Peak, RMS, DC, CrestFactor, ClippedSamples;
+
+        for (const auto & Channel : _Statistics.GetChannels())
+        {
+            const char * Separator = Peak.empty() ? "" : ", ";
+
+            Peak           += msc::FormatText("%s%.2f", Separator, signal_statistics_t::ToDecibels(Channel.Peak));
+            RMS            += msc::FormatText("%s%.2f", Separator, signal_statistics_t::ToDecibels(Channel.RMS));
+            DC             += msc::FormatText("%s%.6f", Separator, Channel.DC);
+            CrestFactor    += msc::FormatText("%s%.2f", Separator, signal_statistics_t::ToDecibels(Channel.CrestFactor));
+            ClippedSamples += msc::FormatText("%s%llu", Separator, Channel.ClippedSamples);
+        }
+
+        fileInfo.info_set("fis_peak_dbfs", Peak.c_str());
+        fileInfo.info_set("fis_rms_dbfs", RMS.c_str());
+        fileInfo.info_set("fis_dc_offset", DC.c_str());
+        fileInfo.info_set("fis_crest_factor_db", CrestFactor.c_str());
+        fileInfo.info_set("fis_clipped_samples", ClippedSamples.c_str());
+    }
+    catch (...)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Lets Csound read the MIDI input from the MIDI file instead of from a MIDI device.
+/// </summary>
+void csound_t::SetMIDICallbacks()
+{
+    if (_CSound.SetOption("-M0") != CSOUND_SUCCESS)
+        throw exception_io("Failed to set Csound option");
+
+    CSOUND * CSound = _CSound.GetCsound();
+
+    ::csoundSetHostMIDIIO(CSound);
+
+    ::csoundSetExternalMidiInOpenCallback(CSound, [](CSOUND * csound, void ** userData, const char *) -> int
+    {
+        *userData = ::csoundGetHostData(csound);
+
+        return 0;
+    });
+
+    // Called at the start of every control cycle. Passes the messages that start before the end of the cycle.
+    ::csoundSetExternalMidiReadCallback(CSound, [](CSOUND * csound, void * userData, unsigned char * data, int size) -> int
+    {
+        auto This = (csound_t *) userData;
+
+        const auto & Events = This->_MIDIFile->Events();
+
+        const double Limit = ::csoundGetScoreTime(csound) + (double) This->_FramesPerControlCycle / (double) This->_SampleRate;
+
+        int Offset = 0;
+
+        while (This->_MIDIIndex < Events.size())
+        {
+            const auto & Event = Events[This->_MIDIIndex];
+
+            if ((Event.Time >= Limit) || (Offset + Event.Size > size))
+                break;
+
+            ::memcpy(data + Offset, Event.Data, Event.Size);
+
+            Offset += Event.Size;
+            ++This->_MIDIIndex;
+        }
+
+        return Offset;
+    });
+
+    ::csoundSetExternalMidiInCloseCallback(CSound, [](CSOUND *, void *) -> int
+    {
+        return 0;
+    });
+}
+
+/// <summary>
+/// Writes the pending channel updates to their control channels. Called at the start of each control cycle.
+/// </summary>
+void csound_t::UpdateChannels() noexcept
+{
+    channel_update_t Update;
+
+    while (_ChannelQueue.Pop(Update))
+    {
+        auto it = std::find_if(_Channels.begin(), _Channels.end(), [&Update](const auto & channel) { return channel.first == Update.Name; });
+
+        if (it == _Channels.end())
+        {
+            void * Data = nullptr;
+
+            if (::csoundGetChannelPtr(_CSound.GetCsound(), &Data, Update.Name, CSOUND_CONTROL_CHANNEL | CSOUND_INPUT_CHANNEL) != CSOUND_SUCCESS)
+            {
+                Log.AtWarn().Write(STR_COMPONENT_NAME " failed to get control channel \"%s\".", Update.Name);
+                continue;
+            }
+
+            it = _Channels.insert(_Channels.end(), { Update.Name, (MYFLT *) Data });
+        }
+
+        *it->second = (MYFLT) Update.Value;
+    }
+}
+
+/// <summary>
+/// Detaches the channel queue from the channel server when rendering ends. Discards the updates that have not been applied.
+/// </summary>
+void csound_t::DetachChannels() noexcept
+{
+    if (!_IsAttached)
+        return;
+
+    channel_server_t::Detach(&_ChannelQueue);
+
+    _IsAttached = false;
+
+    channel_update_t Update;
+
+    while (_ChannelQueue.Pop(Update))
+        ;
+}
+
 /// <summary>
 /// Renders an audio chunk.
 /// </summary>
@@ -104,6 +434,9 @@ bool csound_t::Render(audio_chunk & audioChunk) noexcept
     if (_SrcData == nullptr)
         return false;
 
+    if ((_FrameCount != 0) && (_FrameIndex >= _FrameCount))
+        return false;
+
     bool KeepRendering = true;
 
     audioChunk.set_data_size((t_size) (_FramesPerChunk + 1) * _ChannelCount); // Set the number of samples in the audio chunk. Add room for 1 extra frame of silence.
@@ -112,11 +445,29 @@ bool csound_t::Render(audio_chunk & audioChunk) noexcept
 
     size_t FramesRendered = 0;
 
+    if (_Score)
+        _Score->Feed(_CSound.GetCsound(), _CSound.GetScoreTime());
+
     while (FramesRendered < _FramesPerChunk)
     {
+        // A streamed score keeps Csound running until its last event has ended.
+        if (_Score && _Score->IsFinished(_CSound.GetScoreTime()))
+        {
+            KeepRendering = false;
+            break;
+        }
+
+        UpdateChannels();
+
         auto Result = _CSound.PerformKsmps();
 
-        ::memcpy(DstData,_SrcData, _SamplesPerControlCycle * sizeof(*DstData));
+        // Only the frames up to the end of the subsong are emitted, so only those are counted.
+        size_t FrameCount = _FramesPerControlCycle;
+
+        if (_FrameCount != 0)
+            FrameCount = (size_t) std::min<uint64_t>(FrameCount, _FrameCount - std::min(_FrameCount, _FrameIndex + FramesRendered));
+
+        _Statistics.Process(DstData, (const audio_sample *) _SrcData, FrameCount * _ChannelCount); // Copies the samples.
 
         DstData        += _SamplesPerControlCycle;
         FramesRendered += _FramesPerControlCycle;
@@ -132,6 +483,19 @@ bool csound_t::Render(audio_chunk & audioChunk) noexcept
         }
     }
 
+    // Stop at the end of the subsong.
+    if ((_FrameCount != 0) && (_FrameIndex + FramesRendered > _FrameCount))
+        FramesRendered = (size_t) (_FrameCount - _FrameIndex);
+
+    _FrameIndex += FramesRendered;
+
+    if (!KeepRendering || ((_FrameCount != 0) && (_FrameIndex >= _FrameCount)))
+    {
+        _Statistics.Write();
+
+        DetachChannels();
+    }
+
     audioChunk.set_srate(_SampleRate);
     audioChunk.set_channels(_ChannelCount);         // Set the number of channels in the audio chunk.
     audioChunk.set_sample_count(FramesRendered);    // Set the number of samples per channel in the audio chunk (= number of frames).
@@ -7,29 +7,78 @@
 
 #include <libmsc.h>
 
-class csound_t
+#include "Generator.h"
+#include "Dependencies.h"
+#include "ScoreStream.h"
+#include "MIDIFile.h"
+#include "Subsongs.h"
+#include "ChannelControl.h"
+#include "SignalStatistics.h"
+
+class csound_t : public generator_t
 {
 public:
     csound_t() noexcept;
-    virtual ~csound_t() { }
+    virtual ~csound_t();
+
+    static std::unique_ptr<csound_t> Create();
 
-    void Load(const std::string & content);
+    void Load(const char * text);
 
-    void Start() noexcept;
-    bool Render(audio_chunk & audioChunk) noexcept;
-    void Stop() noexcept;
+    /// <summary>
+    /// Sets the resolved dependencies of the document. They must stay available while Csound is running.
+    /// </summary>
+    void SetDependencies(std::unique_ptr<dependencies_t> && dependencies) noexcept
+    {
+        _Dependencies = std::move(dependencies);
+    }
+
+    /// <summary>
+    /// Sets the score that is streamed to Csound while rendering.
+    /// </summary>
+    void SetScore(std::unique_ptr<score_stream_t> && score) noexcept
+    {
+        _Score = std::move(score);
+    }
+
+    /// <summary>
+    /// Sets the MIDI file that is played through the orchestra. Must be called before the orchestra is loaded.
+    /// </summary>
+    void SetMIDIFile(std::unique_ptr<midi_file_t> && midiFile, double duration) noexcept
+    {
+        _MIDIFile = std::move(midiFile);
+        _Duration = duration;
+    }
+
+    /// <summary>
+    /// Sets the subsongs of the document.
+    /// </summary>
+    void SetSubsongs(std::vector<subsong_t> && subsongs) noexcept
+    {
+        _Subsongs = std::move(subsongs);
+    }
+
+    uint32_t GetSubsongCount() const noexcept override { return _Subsongs.empty() ? 1 : (uint32_t) _Subsongs.size(); }
+    void SelectSubsong(uint32_t subsongIndex) noexcept override { _SubsongIndex = subsongIndex; }
+    uint64_t GetFrameCount(uint32_t subsongIndex) const noexcept override;
+    std::string GetSubsongName(uint32_t subsongIndex) const override;
+
+    void Start() override;
+    bool Render(audio_chunk & audioChunk) noexcept override;
+    void Stop() noexcept override;
+
+    void GetInfo(file_info & fileInfo) const noexcept override;
+    bool GetDynamicInfo(file_info & fileInfo) noexcept override;
 
     std::string GetVersion() noexcept
     {
         int Version = _CSound.GetVersion();
 
-        return msc::FormatText("%d.%d.%d", Version / 1000, (Version % 1000) / 10, Version % 10);
+        return msc::Format("{}.{}.{}", Version / 1000, (Version % 1000) / 10, Version % 10);
     }
 
 public:
-    uint32_t _SampleRate;
     uint32_t _ControlRate;
-    uint32_t _ChannelCount;
     double _0dBFSLevel;
 
     size_t _FramesPerControlCycle;  // Number of audio frames per control cycle.
@@ -37,8 +86,34 @@ public:
     size_t _FramesPerChunk;
 
 private:
+    void SetMIDICallbacks();
+    void UpdateChannels() noexcept;
+    void DetachChannels() noexcept;
+
+private:
+    std::unique_ptr<dependencies_t> _Dependencies; // Declared before _CSound so it is destroyed after Csound has closed the files.
+
     Csound _CSound;
 
     std::string _Line;
     const MYFLT * _SrcData;
+
+    std::unique_ptr<score_stream_t> _Score;
+
+    std::unique_ptr<midi_file_t> _MIDIFile;
+    size_t _MIDIIndex;          // Index of the next MIDI event
+    double _Duration;           // Duration in seconds when playing a MIDI file
+
+    std::vector<subsong_t> _Subsongs;
+    uint32_t _SubsongIndex;
+
+    bool _IsStarted;            // True if Csound has been started. A restart rewinds the score instead.
+    uint64_t _FrameIndex;       // Number of frames rendered since the start
+
+    channel_queue_t _ChannelQueue;                          // Updates of control channels received by the channel server
+    bool _IsAttached;                                       // True if the channel queue is attached to the channel server
+    std::vector<std::pair<std::string, MYFLT *>> _Channels; // Control channels that have been updated
+
+    signal_statistics_t _Statistics;
+    uint64_t _StatisticsFrameIndex; // Frame index of the last update of the dynamic info
 };
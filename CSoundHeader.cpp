@@ -0,0 +1,149 @@
+
+/** $VER: CSoundHeader.cpp (2026.10.19) P. Stuer - Properties of a Csound document read from the orchestra header **/
+
+#include "pch.h"
+
+#include "CSoundHeader.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+/// <summary>
+/// Reads the global variables of the orchestra header. Returns false if they are not all constants or if they are overridden by the options, i.e. if Csound is needed to determine them.
+/// </summary>
+bool csound_header_t::Parse(const char * text)
+{
+    const char * OptionsHead = ::strstr(text, "<CsOptions>");
+    const char * OptionsTail = (OptionsHead != nullptr) ? ::strstr(OptionsHead, "</CsOptions>") : nullptr;
+
+    if (OptionsTail != nullptr)
+    {
+        // Prefix the options with a space to also find an option at the start of the options.
+        const std::string Options = " " + std::string(OptionsHead + 11, OptionsTail);
+
+        for (const char * Option : { " -r", " -k", "\t-r", "\t-k", "\n-r", "\n-k", "--sample-rate", "--control-rate", "--ksmps", "--nchnls", "--0dbfs", "--omacro", "--smacro" })
+        {
+            if (Options.find(Option) != std::string::npos)
+                return false;
+        }
+    }
+
+    const char * OrchestraHead = ::strstr(text, "<CsInstruments>");
+    const char * OrchestraTail = (OrchestraHead != nullptr) ? ::strstr(OrchestraHead, "</CsInstruments>") : nullptr;
+
+    if (OrchestraTail == nullptr)
+        return false;
+
+    // The defaults of Csound 7.
+    double SampleRate = 44100., ControlRate = 0., Ksmps = 10., ChannelCount = 1., ZeroDBFS = 1.;
+
+    // The variables that have been assigned: sr, kr or ksmps, nchnls and 0dbfs.
+    uint32_t Assigned = 0;
+    const uint32_t AllAssigned = 0x0F;
+
+    for (const char * Line = OrchestraHead + 15; Line < OrchestraTail;)
+    {
+        const char * LineTail = Line;
+
+        while ((LineTail < OrchestraTail) && (*LineTail != '\n'))
+            ++LineTail;
+
+        std::string Statement(Line, LineTail);
+
+        Line = (LineTail < OrchestraTail) ? LineTail + 1 : OrchestraTail;
+
+        Statement = Statement.substr(0, Statement.find(';'));
+        Statement = Statement.substr(0, Statement.find("//"));
+
+        if (Statement.find("/*") != std::string::npos)
+            return false;
+
+        Statement.erase(0, Statement.find_first_not_of(" \t"));
+        Statement.erase(Statement.find_last_not_of(" \t\r") + 1);
+
+        if (Statement.empty())
+            continue;
+
+        // The header ends at the first instrument or user-defined opcode.
+        if (Statement.starts_with("instr") || Statement.starts_with("opcode"))
+            break;
+
+        const size_t Equals = Statement.find('=');
+
+        std::string Name = (Equals != std::string::npos) ? Statement.substr(0, Equals) : std::string();
+        std::string Value = (Equals != std::string::npos) ? Statement.substr(Equals + 1) : std::string();
+
+        Name.erase(Name.find_last_not_of(" \t") + 1);
+        Value.erase(0, Value.find_first_not_of(" \t"));
+
+        double * Variable = nullptr;
+
+        if (Name == "sr")       { Variable = &SampleRate;   Assigned |= 0x01; } else
+        if (Name == "kr")       { Variable = &ControlRate;  Assigned |= 0x02; } else
+        if (Name == "ksmps")    { Variable = &Ksmps;        Assigned |= 0x02; } else
+        if (Name == "nchnls")   { Variable = &ChannelCount; Assigned |= 0x04; } else
+        if (Name == "0dbfs")    { Variable = &ZeroDBFS;     Assigned |= 0x08; } else
+        if ((Name == "nchnls_i") || (Name == "A4"))
+            continue;
+
+        if (Variable == nullptr)
+        {
+            // Global code, a directive or a macro may change a variable that has not been assigned yet.
+            if (Assigned != AllAssigned)
+                return false;
+
+            break;
+        }
+
+        char * End;
+
+        *Variable = std::strtod(Value.c_str(), &End);
+
+        if ((*End != '\0') || !(*Variable > 0.))
+            return false;
+    }
+
+    if ((SampleRate != std::floor(SampleRate)) || (ChannelCount != std::floor(ChannelCount)) || (ChannelCount > 64.))
+        return false;
+
+    if (ControlRate == 0.)
+        ControlRate = SampleRate / Ksmps;
+
+    _SampleRate   = (uint32_t) SampleRate;
+    _ControlRate  = (uint32_t) ControlRate;
+    _ChannelCount = (uint32_t) ChannelCount;
+    _0dBFSLevel   = ZeroDBFS;
+
+    return true;
+}
+
+/// <summary>
+/// Gets the number of frames of the specified subsong, 0 if infinite.
+/// </summary>
+uint64_t csound_header_t::GetFrameCount(uint32_t subsongIndex) const noexcept
+{
+    if (subsongIndex >= _Subsongs.size())
+        return _FrameCount;
+
+    return (uint64_t) (_Subsongs[subsongIndex].Duration * _SampleRate + .5);
+}
+
+/// <summary>
+/// Gets the name of the specified subsong.
+/// </summary>
+std::string csound_header_t::GetSubsongName(uint32_t subsongIndex) const
+{
+    return (subsongIndex < _Subsongs.size()) ? _Subsongs[subsongIndex].Name : std::string();
+}
+
+/// <summary>
+/// Adds generator specific info tags. The same tags as the Csound generator.
+/// </summary>
+void csound_header_t::GetInfo(file_info & fileInfo) const noexcept
+{
+    fileInfo.info_set_int("fis_control_rate", _ControlRate);
+    fileInfo.info_set_int("fis_channel_count", _ChannelCount);
+    fileInfo.info_set_int("fis_0dbfs_level", (int64_t) _0dBFSLevel);
+}
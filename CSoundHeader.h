@@ -0,0 +1,40 @@
+
+/** $VER: CSoundHeader.h (2026.10.19) P. Stuer - Properties of a Csound document read from the orchestra header **/
+
+#pragma once
+
+#include "Generator.h"
+#include "Subsongs.h"
+
+/// <summary>
+/// Represents the properties of a Csound document that are read from the header of the orchestra, without creating a Csound instance.
+/// Used when foobar2000 only needs the information of a file. It can't render.
+/// </summary>
+class csound_header_t : public generator_t
+{
+public:
+    csound_header_t() noexcept : _ControlRate(), _0dBFSLevel() { }
+
+    bool Parse(const char * text);
+
+    void SetSubsongs(std::vector<subsong_t> && subsongs) noexcept
+    {
+        _Subsongs = std::move(subsongs);
+    }
+
+    void Start() noexcept override { }
+    bool Render(audio_chunk &) noexcept override { return false; }
+    void Stop() noexcept override { }
+
+    uint32_t GetSubsongCount() const noexcept override { return _Subsongs.empty() ? 1 : (uint32_t) _Subsongs.size(); }
+    uint64_t GetFrameCount(uint32_t subsongIndex) const noexcept override;
+    std::string GetSubsongName(uint32_t subsongIndex) const override;
+
+    void GetInfo(file_info & fileInfo) const noexcept override;
+
+private:
+    uint32_t _ControlRate;
+    double _0dBFSLevel;
+
+    std::vector<subsong_t> _Subsongs;
+};
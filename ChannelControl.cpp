@@ -0,0 +1,203 @@
+
+/** $VER: ChannelControl.cpp (2026.10.19) P. Stuer - Live control of Csound channels **/
+
+#include "pch.h"
+
+#include "ChannelControl.h"
+#include "Configuration.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+static const wchar_t * PipeName = L"\\\\.\\pipe\\" STR_COMPONENT_BASENAME;
+
+msc::critical_section_t channel_server_t::_Lock;
+std::vector<channel_queue_t *> channel_server_t::_Queues;
+std::jthread channel_server_t::_Thread;
+
+/// <summary>
+/// Adds an update to the queue. Returns false if the queue is full or the name is too long.
+/// </summary>
+bool channel_queue_t::Push(const char * name, size_t size, double value) noexcept
+{
+    if (size >= sizeof(channel_update_t::Name))
+        return false;
+
+    const size_t Tail = _Tail.load(std::memory_order_relaxed);
+
+    if (Tail - _Head.load(std::memory_order_acquire) == Capacity)
+        return false;
+
+    auto & Item = _Items[Tail & (Capacity - 1)];
+
+    ::memcpy(Item.Name, name, size);
+    Item.Name[size] = '\0';
+    Item.Value = value;
+
+    _Tail.store(Tail + 1, std::memory_order_release);
+
+    return true;
+}
+
+/// <summary>
+/// Removes the oldest update from the queue. Returns false if the queue is empty.
+/// </summary>
+bool channel_queue_t::Pop(channel_update_t & update) noexcept
+{
+    const size_t Head = _Head.load(std::memory_order_relaxed);
+
+    if (Head == _Tail.load(std::memory_order_acquire))
+        return false;
+
+    update = _Items[Head & (Capacity - 1)];
+
+    _Head.store(Head + 1, std::memory_order_release);
+
+    return true;
+}
+
+/// <summary>
+/// Attaches the queue of a Csound instance to the server. Starts the server if it is enabled and not running yet.
+/// </summary>
+void channel_server_t::Attach(channel_queue_t * queue)
+{
+    if (!CfgChannelServer.get())
+        return;
+
+    _Lock.Enter();
+
+    _Queues.push_back(queue);
+
+    if (!_Thread.joinable())
+        _Thread = std::jthread(Run);
+
+    _Lock.Leave();
+}
+
+/// <summary>
+/// Detaches the queue of a Csound instance from the server.
+/// </summary>
+void channel_server_t::Detach(channel_queue_t * queue) noexcept
+{
+    _Lock.Enter();
+
+    std::erase(_Queues, queue);
+
+    _Lock.Leave();
+}
+
+/// <summary>
+/// Stops the server.
+/// </summary>
+void channel_server_t::Stop() noexcept
+{
+    if (!_Thread.joinable())
+        return;
+
+    _Thread.request_stop();
+
+    // Cancel a pending read and connect to the pipe in case the server is still waiting for a client.
+    (void) ::CancelSynchronousIo(_Thread.native_handle());
+
+    HANDLE hPipe = ::CreateFileW(PipeName, GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+
+    if (hPipe != INVALID_HANDLE_VALUE)
+        ::CloseHandle(hPipe);
+
+    _Thread.join();
+}
+
+/// <summary>
+/// Accepts clients and reads their updates, one per line: "<channel name> <value>".
+/// </summary>
+void channel_server_t::Run(std::stop_token stopToken) noexcept
+{
+    Log.AtInfo().Write(STR_COMPONENT_NAME " is accepting channel updates.");
+
+    while (!stopToken.stop_requested())
+    {
+        HANDLE hPipe = ::CreateNamedPipeW(PipeName, PIPE_ACCESS_INBOUND, PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS, 1, 0, 4096, 0, nullptr);
+
+        if (hPipe == INVALID_HANDLE_VALUE)
+        {
+            Log.AtError().Write(STR_COMPONENT_NAME " failed to create the channel pipe: 0x%08X.", ::GetLastError());
+            return;
+        }
+
+        if (::ConnectNamedPipe(hPipe, nullptr) || (::GetLastError() == ERROR_PIPE_CONNECTED))
+        {
+            std::string Line;
+            char Data[4096];
+            DWORD Size;
+
+            while (!stopToken.stop_requested() && ::ReadFile(hPipe, Data, sizeof(Data), &Size, nullptr) && (Size != 0))
+            {
+                for (DWORD i = 0; i < Size; ++i)
+                {
+                    if (Data[i] == '\n')
+                    {
+                        Dispatch(Line.c_str(), Line.size());
+                        Line.clear();
+                    }
+                    else
+                    if (Data[i] != '\r')
+                        Line += Data[i];
+                }
+            }
+        }
+
+        ::DisconnectNamedPipe(hPipe);
+        ::CloseHandle(hPipe);
+    }
+}
+
+/// <summary>
+/// Parses an update and pushes it to all attached queues.
+/// </summary>
+void channel_server_t::Dispatch(const char * line, size_t size) noexcept
+{
+    const char * Tail = line + size;
+
+    while ((line < Tail) && ::isspace((uint8_t) *line))
+        ++line;
+
+    const char * Name = line;
+
+    while ((line < Tail) && !::isspace((uint8_t) *line))
+        ++line;
+
+    const size_t NameSize = (size_t) (line - Name);
+
+    char * End = nullptr;
+
+    const double Value = ::strtod(line, &End);
+
+    if ((NameSize == 0) || (End == line))
+    {
+        Log.AtWarn().Write(STR_COMPONENT_NAME " ignores invalid channel update \"%.*s\".", (int) size, Name);
+        return;
+    }
+
+    _Lock.Enter();
+
+    for (auto Queue : _Queues)
+    {
+        if (!Queue->Push(Name, NameSize, Value))
+            Log.AtWarn().Write(STR_COMPONENT_NAME " drops update of channel \"%.*s\".", (int) NameSize, Name);
+    }
+
+    _Lock.Leave();
+}
+
+/// <summary>
+/// Stops the channel server when foobar2000 shuts down.
+/// </summary>
+class channel_server_quit_t : public initquit
+{
+public:
+    void on_quit() noexcept override { channel_server_t::Stop(); }
+};
+
+static initquit_factory_t<channel_server_quit_t> _ChannelServerQuit;
@@ -0,0 +1,59 @@
+
+/** $VER: ChannelControl.h (2026.10.19) P. Stuer - Live control of Csound channels **/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Represents a new value for a control channel.
+/// </summary>
+struct channel_update_t
+{
+    char Name[56];
+    double Value;
+};
+
+/// <summary>
+/// Implements a lock-free single-producer, single-consumer queue of channel updates. The producer is the channel server; the consumer is the thread that renders the audio.
+/// </summary>
+class channel_queue_t
+{
+public:
+    channel_queue_t() noexcept : _Items(), _Head(0), _Tail(0) { }
+
+    bool Push(const char * name, size_t size, double value) noexcept;
+    bool Pop(channel_update_t & update) noexcept;
+
+private:
+    static const size_t Capacity = 256; // Must be a power of 2
+
+    std::array<channel_update_t, Capacity> _Items;
+
+    alignas(64) std::atomic<size_t> _Head; // Index of the next item to pop. Written by the consumer.
+    alignas(64) std::atomic<size_t> _Tail; // Index of the next item to push. Written by the producer.
+};
+
+/// <summary>
+/// Implements a named pipe server that accepts channel updates from other processes, e.g. test drivers, and forwards them to the queues of all attached Csound instances.
+/// </summary>
+class channel_server_t
+{
+public:
+    static void Attach(channel_queue_t * queue);
+    static void Detach(channel_queue_t * queue) noexcept;
+
+    static void Stop() noexcept;
+
+private:
+    static void Run(std::stop_token stopToken) noexcept;
+    static void Dispatch(const char * line, size_t size) noexcept;
+
+private:
+    static msc::critical_section_t _Lock;
+    static std::vector<channel_queue_t *> _Queues;
+    static std::jthread _Thread;
+};
@@ -0,0 +1,339 @@
+
+/** $VER: ChannelPattern.cpp (2026.10.19) P. Stuer - Multichannel test patterns **/
+
+#include "pch.h"
+
+#include "ChannelPattern.h"
+#include "SignalDocument.h"
+
+#include <numbers>
+
+#pragma hdrstop
+
+static_assert(sizeof(audio_sample) == sizeof(double), "sizeof(audio_sample) != sizeof(double)");
+
+static const double PinkScale = 1. / 1.764; // Scales the output of the pink noise filter to an RMS level of 1.
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+channel_pattern_t::channel_pattern_t(const signal_document_t & document) : native_generator_t(document), _Position(), _SlotSize(), _BeepPeriod(), _Seed(), _CommonGain(1.), _IndependentGain()
+{
+    const std::string Name = document.GetString("generator");
+
+    if (msc::IsOneOf(Name.c_str(), { "channel-ident" }))
+        _Pattern = pattern_t::Ident;
+    else
+    if (msc::IsOneOf(Name.c_str(), { "channel-polarity" }))
+        _Pattern = pattern_t::Polarity;
+    else
+    if (msc::IsOneOf(Name.c_str(), { "channel-rotation" }))
+        _Pattern = pattern_t::Rotation;
+    else
+        _Pattern = pattern_t::Noise;
+
+    const double SampleRate = (double) _SampleRate;
+
+    switch (_Pattern)
+    {
+        case pattern_t::Ident:
+        {
+            // Beeps of 100 ms every 200 ms with 5 ms raised cosine ramps. The slot is long enough for the highest channel number and a pause.
+            const double Frequency = document.GetDouble("frequency", 1000., 20., SampleRate / 2.);
+
+            _BeepPeriod = (size_t) (0.2 * SampleRate);
+            _Template.resize(_BeepPeriod / 2);
+
+            const size_t RampSize = (size_t) (0.005 * SampleRate);
+
+            for (size_t i = 0; i < _Template.size(); ++i)
+            {
+                double Gain = _Level;
+
+                const size_t Distance = std::min(i, _Template.size() - 1 - i);
+
+                if (Distance < RampSize)
+                    Gain *= 0.5 - 0.5 * std::cos(std::numbers::pi * (double) Distance / (double) RampSize);
+
+                _Template[i] = Gain * std::sin(2. * std::numbers::pi * Frequency * (double) i / SampleRate);
+            }
+
+            _SlotSize = (uint64_t) (document.GetDouble("slot", 0.2 * _ChannelCount + 1., 0.2 * _ChannelCount, 3600.) * SampleRate);
+            break;
+        }
+
+        case pattern_t::Polarity:
+        {
+            // A positive Hann pulse of 2 ms at the start of every period.
+            const double Frequency = document.GetDouble("frequency", 4., 0.1, 100.);
+
+            _Template.assign((size_t) (SampleRate / Frequency), 0.);
+
+            const size_t PulseSize = std::min((size_t) (0.002 * SampleRate), _Template.size());
+
+            for (size_t i = 0; i < PulseSize; ++i)
+                _Template[i] = _Level * (0.5 - 0.5 * std::cos(2. * std::numbers::pi * (double) i / (double) PulseSize));
+
+            _Gains.assign(_ChannelCount, 1.);
+
+            for (const double Channel : document.GetDoubles("inverted"))
+            {
+                if ((Channel < 1.) || (Channel > _ChannelCount) || (Channel != std::floor(Channel)))
+                    throw exception_io_data(msc::FormatText("Invalid channel number %g", Channel).c_str());
+
+                _Gains[(size_t) Channel - 1] = -1.;
+            }
+            break;
+        }
+
+        case pattern_t::Rotation:
+        case pattern_t::Noise:
+        {
+            // The level of noise is an RMS level.
+            if (!document.Has("level"))
+                _Level = std::pow(10., -20. / 20.);
+
+            _Seed = (uint64_t) document.GetInteger("seed", 1, 0, INT64_MAX);
+
+            if (_Pattern == pattern_t::Rotation)
+                _SlotSize = (uint64_t) (document.GetDouble("slot", 2., 0.01, 3600.) * SampleRate);
+            else
+            {
+                const double Correlation = document.GetDouble("correlation", msc::IsOneOf(Name.c_str(), { "noise-correlated" }) ? 1. : 0., 0., 1.);
+
+                // Mixing the common and the independent noise with these gains keeps the RMS level constant.
+                _CommonGain      = std::sqrt(Correlation);
+                _IndependentGain = std::sqrt(1. - Correlation);
+            }
+
+            const size_t LaneCount = (size_t) _ChannelCount + 1;
+
+            _Noise.State.resize(LaneCount);
+
+            for (auto * Lane : { &_Noise.B0, &_Noise.B1, &_Noise.B2, &_Noise.B3, &_Noise.B4, &_Noise.B5, &_Noise.B6, &_Noise.Pink })
+                Lane->resize(LaneCount);
+
+            ResetNoise(0);
+            break;
+        }
+    }
+}
+
+/// <summary>
+/// Returns true if the specified name identifies one of the signals of this generator.
+/// </summary>
+bool channel_pattern_t::IsOurGenerator(const std::string & name) noexcept
+{
+    return msc::IsOneOf(name.c_str(), { "channel-ident", "channel-polarity", "channel-rotation", "noise-correlated", "noise-decorrelated" });
+}
+
+/// <summary>
+/// Adds generator specific info tags.
+/// </summary>
+void channel_pattern_t::GetInfo(file_info & fileInfo) const noexcept
+{
+    fileInfo.info_set_int("fis_channel_config", (int64_t) _ChannelConfig);
+
+    if (_Pattern == pattern_t::Noise)
+        fileInfo.info_set_float("fis_correlation", _CommonGain * _CommonGain, 2);
+}
+
+/// <summary>
+/// Generates the specified number of interleaved frames at the current position.
+/// </summary>
+void channel_pattern_t::Generate(audio_sample * data, size_t frameCount) noexcept
+{
+    switch (_Pattern)
+    {
+        case pattern_t::Ident:    GenerateIdent(data, frameCount); break;
+        case pattern_t::Polarity: GeneratePolarity(data, frameCount); break;
+        case pattern_t::Rotation: GenerateRotation(data, frameCount); break;
+        case pattern_t::Noise:    GenerateNoise(data, frameCount); break;
+    }
+
+    _Position += frameCount;
+}
+
+/// <summary>
+/// Moves the generator to the specified frame.
+/// </summary>
+void channel_pattern_t::SetPosition(uint64_t frameIndex) noexcept
+{
+    _Position = frameIndex;
+
+    if ((_Pattern == pattern_t::Rotation) || (_Pattern == pattern_t::Noise))
+        ResetNoise(frameIndex);
+}
+
+/// <summary>
+/// Generates the channel identification pattern. Only one channel is active at any time so the output is cleared and a single channel is written with a stride.
+/// </summary>
+void channel_pattern_t::GenerateIdent(audio_sample * data, size_t frameCount) noexcept
+{
+    const size_t ChannelCount = _ChannelCount;
+
+    std::fill(data, data + frameCount * ChannelCount, 0.);
+
+    for (size_t i = 0; i < frameCount;)
+    {
+        const uint64_t Position = _Position + i;
+        const size_t Channel = (size_t) ((Position / _SlotSize) % ChannelCount);
+        const uint64_t Offset = Position % _SlotSize;
+
+        // Stop at the end of the slot or the current beep period, whichever comes first.
+        const size_t BeepIndex = (size_t) (Offset / _BeepPeriod);
+        const size_t BeepOffset = (size_t) (Offset % _BeepPeriod);
+
+        const size_t n = (size_t) std::min({ (uint64_t) (frameCount - i), _SlotSize - Offset, (uint64_t) (_BeepPeriod - BeepOffset) });
+
+        if ((BeepIndex <= Channel) && (BeepOffset < _Template.size()))
+        {
+            const size_t m = std::min(n, _Template.size() - BeepOffset);
+
+            const double * Src = _Template.data() + BeepOffset;
+            audio_sample * Dst = data + i * ChannelCount + Channel;
+
+            for (size_t j = 0; j < m; ++j)
+                Dst[j * ChannelCount] = Src[j];
+        }
+
+        i += n;
+    }
+}
+
+/// <summary>
+/// Generates the polarity pattern. Every frame is the pulse multiplied by a row of channel gains.
+/// </summary>
+void channel_pattern_t::GeneratePolarity(audio_sample * data, size_t frameCount) noexcept
+{
+    const size_t ChannelCount = _ChannelCount;
+    const size_t PeriodSize = _Template.size();
+    const double * Gains = _Gains.data();
+
+    size_t Offset = (size_t) (_Position % PeriodSize);
+
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        const double Value = _Template[Offset];
+
+        audio_sample * Row = data + i * ChannelCount;
+
+        for (size_t j = 0; j < ChannelCount; ++j)
+            Row[j] = Value * Gains[j];
+
+        if (++Offset == PeriodSize)
+            Offset = 0;
+    }
+}
+
+/// <summary>
+/// Generates pink noise that moves from channel to channel. Only the common noise lane is calculated.
+/// </summary>
+void channel_pattern_t::GenerateRotation(audio_sample * data, size_t frameCount) noexcept
+{
+    const size_t ChannelCount = _ChannelCount;
+    const size_t Lane = ChannelCount;
+    const double Gain = _Level * PinkScale;
+
+    std::fill(data, data + frameCount * ChannelCount, 0.);
+
+    uint64_t x = _Noise.State[Lane];
+
+    double b0 = _Noise.B0[Lane], b1 = _Noise.B1[Lane], b2 = _Noise.B2[Lane], b3 = _Noise.B3[Lane], b4 = _Noise.B4[Lane], b5 = _Noise.B5[Lane], b6 = _Noise.B6[Lane];
+
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+
+        const double w = (double) (x >> 11) * (2. / 9007199254740992.) - 1.;
+
+        b0 = 0.99886 * b0 + w * 0.0555179;
+        b1 = 0.99332 * b1 + w * 0.0750759;
+        b2 = 0.96900 * b2 + w * 0.1538520;
+        b3 = 0.86650 * b3 + w * 0.3104856;
+        b4 = 0.55000 * b4 + w * 0.5329522;
+        b5 = -0.7616 * b5 - w * 0.0168980;
+
+        const double Pink = b0 + b1 + b2 + b3 + b4 + b5 + b6 + w * 0.5362;
+
+        b6 = w * 0.115926;
+
+        const size_t Channel = (size_t) (((_Position + i) / _SlotSize) % ChannelCount);
+
+        data[i * ChannelCount + Channel] = Gain * Pink;
+    }
+
+    _Noise.State[Lane] = x;
+
+    _Noise.B0[Lane] = b0; _Noise.B1[Lane] = b1; _Noise.B2[Lane] = b2; _Noise.B3[Lane] = b3; _Noise.B4[Lane] = b4; _Noise.B5[Lane] = b5; _Noise.B6[Lane] = b6;
+}
+
+/// <summary>
+/// Generates pink noise in all channels. The filter state of all channels is stored in contiguous lanes so each frame is calculated in one pass over the lanes.
+/// </summary>
+void channel_pattern_t::GenerateNoise(audio_sample * data, size_t frameCount) noexcept
+{
+    const size_t ChannelCount = _ChannelCount;
+    const size_t LaneCount = ChannelCount + 1;
+
+    uint64_t * State = _Noise.State.data();
+
+    double * B0 = _Noise.B0.data(), * B1 = _Noise.B1.data(), * B2 = _Noise.B2.data(), * B3 = _Noise.B3.data(), * B4 = _Noise.B4.data(), * B5 = _Noise.B5.data(), * B6 = _Noise.B6.data();
+    double * Pink = _Noise.Pink.data();
+
+    const double CommonGain      = _Level * PinkScale * _CommonGain;
+    const double IndependentGain = _Level * PinkScale * _IndependentGain;
+
+    for (size_t i = 0; i < frameCount; ++i)
+    {
+        for (size_t j = 0; j < LaneCount; ++j)
+        {
+            uint64_t x = State[j];
+
+            x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+
+            State[j] = x;
+
+            const double w = (double) (x >> 11) * (2. / 9007199254740992.) - 1.;
+
+            B0[j] = 0.99886 * B0[j] + w * 0.0555179;
+            B1[j] = 0.99332 * B1[j] + w * 0.0750759;
+            B2[j] = 0.96900 * B2[j] + w * 0.1538520;
+            B3[j] = 0.86650 * B3[j] + w * 0.3104856;
+            B4[j] = 0.55000 * B4[j] + w * 0.5329522;
+            B5[j] = -0.7616 * B5[j] - w * 0.0168980;
+
+            Pink[j] = B0[j] + B1[j] + B2[j] + B3[j] + B4[j] + B5[j] + B6[j] + w * 0.5362;
+
+            B6[j] = w * 0.115926;
+        }
+
+        const double Common = CommonGain * Pink[ChannelCount];
+
+        audio_sample * Row = data + i * ChannelCount;
+
+        for (size_t j = 0; j < ChannelCount; ++j)
+            Row[j] = Common + IndependentGain * Pink[j];
+    }
+}
+
+/// <summary>
+/// Resets the noise generators. The random number generators are seeded from the seed and the frame index so playback after a seek is repeatable.
+/// </summary>
+void channel_pattern_t::ResetNoise(uint64_t frameIndex) noexcept
+{
+    for (size_t j = 0; j < _Noise.State.size(); ++j)
+    {
+        // SplitMix64 of the seed, the frame index and the lane. 0 is not a valid xorshift state.
+        uint64_t z = _Seed + 0x9E3779B97F4A7C15ull * (frameIndex * _Noise.State.size() + j + 1);
+
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z =  z ^ (z >> 31);
+
+        _Noise.State[j] = (z != 0) ? z : 1;
+    }
+
+    for (auto * Lane : { &_Noise.B0, &_Noise.B1, &_Noise.B2, &_Noise.B3, &_Noise.B4, &_Noise.B5, &_Noise.B6 })
+        std::fill(Lane->begin(), Lane->end(), 0.);
+}
@@ -0,0 +1,64 @@
+
+/** $VER: ChannelPattern.h (2026.10.19) P. Stuer - Multichannel test patterns **/
+
+#pragma once
+
+#include "Generator.h"
+
+#include <vector>
+
+/// <summary>
+/// Generates multichannel test patterns: channel identification, polarity, rotating pink noise and (partially) correlated pink noise.
+/// Every pattern writes the interleaved output directly. The work per frame is either a single strided store or one pass over a contiguous row of channels.
+/// </summary>
+class channel_pattern_t : public native_generator_t
+{
+public:
+    channel_pattern_t(const signal_document_t & document);
+
+    static bool IsOurGenerator(const std::string & name) noexcept;
+
+    void GetInfo(file_info & fileInfo) const noexcept override;
+
+protected:
+    void Generate(audio_sample * data, size_t frameCount) noexcept override;
+    void SetPosition(uint64_t frameIndex) noexcept override;
+
+private:
+    enum class pattern_t
+    {
+        Ident,      // Each channel in turn beeps its 1-based channel number.
+        Polarity,   // Positive pulses in all channels, optionally inverted per channel.
+        Rotation,   // Pink noise that moves from channel to channel.
+        Noise,      // Pink noise in all channels with a configurable inter-channel correlation.
+    };
+
+    void GenerateIdent(audio_sample * data, size_t frameCount) noexcept;
+    void GeneratePolarity(audio_sample * data, size_t frameCount) noexcept;
+    void GenerateRotation(audio_sample * data, size_t frameCount) noexcept;
+    void GenerateNoise(audio_sample * data, size_t frameCount) noexcept;
+
+    void ResetNoise(uint64_t frameIndex) noexcept;
+
+private:
+    pattern_t _Pattern;
+    uint64_t _Position;
+
+    uint64_t _SlotSize;                 // Number of frames each channel is active (Ident, Rotation)
+    size_t _BeepPeriod;                 // Number of frames between the start of two beeps (Ident)
+
+    std::vector<double> _Template;      // Beep (Ident) or one period of the pulse train (Polarity)
+    std::vector<double> _Gains;         // Gain of each channel (Polarity)
+
+    // Pink noise filter state (Paul Kellet's refined method). One lane per channel and one extra lane for the signal common to all channels.
+    struct noise_t
+    {
+        std::vector<uint64_t> State;
+        std::vector<double> B0, B1, B2, B3, B4, B5, B6;
+        std::vector<double> Pink;
+    } _Noise;
+
+    uint64_t _Seed;
+    double _CommonGain;
+    double _IndependentGain;
+};
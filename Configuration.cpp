@@ -0,0 +1,38 @@
+
+/** $VER: Configuration.cpp (2026.10.19) P. Stuer - Advanced preferences **/
+
+#include "pch.h"
+
+#include "Configuration.h"
+#include "Resources.h"
+
+#pragma hdrstop
+
+static constexpr GUID BranchGUID = { 0x209a2e83, 0x7595, 0x4741, { 0xac, 0x64, 0xe6, 0x7d, 0x47, 0x09, 0xc8, 0x13 } };
+
+static advconfig_branch_factory Branch(STR_COMPONENT_NAME, BranchGUID, advconfig_branch::guid_branch_decoding, 0.);
+
+/// <summary>
+/// Stores streamed scores in a precompiled binary format in the profile folder so they don't have to be parsed again.
+/// </summary>
+advconfig_checkbox_factory CfgScoreCache("Cache precompiled scores", { 0x3c3fdeb4, 0xea08, 0x4f2d, { 0xbd, 0x98, 0xba, 0xb7, 0x15, 0x7a, 0x0d, 0xc2 } }, BranchGUID, 1., true);
+
+/// <summary>
+/// Directory from which Csound loads its opcode plugins. Empty to use the default directory of Csound. A directory with only the plugins that are needed makes opening files faster.
+/// </summary>
+advconfig_string_factory CfgOpcodeDirectory("Csound opcode directory", { 0x6cab656e, 0x13d3, 0x41f6, { 0xb4, 0x26, 0xb2, 0x14, 0x27, 0x0b, 0x3d, 0x26 } }, BranchGUID, 2., "");
+
+/// <summary>
+/// Accepts updates of Csound control channels from other processes through the named pipe \\.\pipe\foo_input_signal.
+/// </summary>
+advconfig_checkbox_factory CfgChannelServer("Accept channel updates through a named pipe", { 0x8541bb15, 0xe58c, 0x46fa, { 0x81, 0xc8, 0x25, 0x4c, 0x1a, 0x3c, 0x8c, 0x2f } }, BranchGUID, 3., false);
+
+/// <summary>
+/// Hashes the generated output and compares it with the golden hashes in "<file>.xxh64". The golden hashes are written when the file doesn't exist.
+/// </summary>
+advconfig_checkbox_factory CfgOutputHash("Verify the output against golden hashes", { 0x30b6ffc0, 0x5f7e, 0x4d78, { 0xab, 0xc5, 0xc4, 0x3e, 0xfd, 0xc5, 0x28, 0xd0 } }, BranchGUID, 4., false);
+
+/// <summary>
+/// Verifies the spectrum of the generated output against the assertions in "<file>.spectrum", if it exists.
+/// </summary>
+advconfig_checkbox_factory CfgSpectrumVerification("Verify the spectrum of the output", { 0x8053df93, 0x682e, 0x4451, { 0xb6, 0x6d, 0xfe, 0x9c, 0x61, 0x3c, 0x81, 0xd2 } }, BranchGUID, 5., false);
@@ -0,0 +1,12 @@
+
+/** $VER: Configuration.h (2026.10.19) P. Stuer - Advanced preferences **/
+
+#pragma once
+
+#include <sdk/advconfig_impl.h>
+
+extern advconfig_checkbox_factory CfgScoreCache;
+extern advconfig_string_factory CfgOpcodeDirectory;
+extern advconfig_checkbox_factory CfgChannelServer;
+extern advconfig_checkbox_factory CfgOutputHash;
+extern advconfig_checkbox_factory CfgSpectrumVerification;
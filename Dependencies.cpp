@@ -0,0 +1,380 @@
+
+/** $VER: Dependencies.cpp (2026.10.19) P. Stuer - Resolves the files a CSD depends on through the foobar2000 file system **/
+
+#include "pch.h"
+
+#include "Dependencies.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+static const char * SkipComment(const char * text) noexcept;
+static bool IsSoundFile(const std::string & fileName) noexcept;
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+dependencies_t::dependencies_t(const char * documentPath, bool readAhead) : _Directory(pfc::string_directory(documentPath).c_str()), _ReadAhead(readAhead)
+{
+}
+
+/// <summary>
+/// Stops reading ahead and deletes the temporary files.
+/// </summary>
+dependencies_t::~dependencies_t() noexcept
+{
+    if (_ReadAheadThread.joinable())
+    {
+        _ReadAheadThread.request_stop();
+        _ReadAheadThread.join();
+    }
+
+    for (const auto & FilePath : _TemporaryFiles)
+        ::DeleteFileW(FilePath.c_str());
+}
+
+/// <summary>
+/// Resolves the dependencies of the specified text. Returns true and the new text if anything was changed.
+/// </summary>
+bool dependencies_t::Resolve(const char * text, std::string & rewrittenText, abort_callback & abortHandler)
+{
+    std::string Text;
+
+    const bool HasIncludes = InlineIncludes(_Directory, text, Text, 0, abortHandler);
+
+    if (HasIncludes)
+        text = Text.c_str();
+
+    const bool HasSoundFiles = ResolveSoundFiles(text, rewrittenText, abortHandler);
+
+    if (!HasSoundFiles && HasIncludes)
+        rewrittenText = std::move(Text);
+
+    if (!_ReadAheadFiles.empty() && !_ReadAheadThread.joinable())
+        _ReadAheadThread = std::jthread(ReadAhead, _ReadAheadFiles);
+
+    return HasIncludes || HasSoundFiles;
+}
+
+/// <summary>
+/// Replaces the #include directives with the content of the included file. The file name is relative to the directory of the including file.
+/// </summary>
+bool dependencies_t::InlineIncludes(const std::string & directory, const char * text, std::string & rewrittenText, int depth, abort_callback & abortHandler)
+{
+    if (::strstr(text, "#include") == nullptr)
+        return false;
+
+    if (depth == MaxIncludeDepth)
+        throw exception_io_data("Too many nested #include directives");
+
+    const char * Curr = text;
+    bool IsChanged = false;
+
+    for (const char * Line = text; *Line != '\0';)
+    {
+        const char * Head = Line;
+
+        while ((*Head == ' ') || (*Head == '\t'))
+            ++Head;
+
+        const char * Tail = ::strchr(Line, '\n');
+
+        if (Tail == nullptr)
+            Tail = Line + ::strlen(Line);
+
+        if (::strncmp(Head, "#include", 8) == 0)
+        {
+            // The file name is enclosed by any character, usually double quotes.
+            const char * Name = Head + 8;
+
+            while ((Name < Tail) && ((*Name == ' ') || (*Name == '\t')))
+                ++Name;
+
+            const char * NameTail = (Name < Tail) ? (const char *) ::memchr(Name + 1, *Name, (size_t) (Tail - Name - 1)) : nullptr;
+
+            if (NameTail != nullptr)
+            {
+                const std::string FilePath = Combine(directory, std::string(Name + 1, NameTail));
+
+                const std::string Content = ReadText(FilePath, abortHandler);
+
+                std::string Included;
+
+                rewrittenText.append(Curr, Line);
+
+                if (InlineIncludes(pfc::string_directory(FilePath.c_str()).c_str(), Content.c_str(), Included, depth + 1, abortHandler))
+                    rewrittenText += Included;
+                else
+                    rewrittenText += Content;
+
+                rewrittenText += '\n';
+
+                Log.AtDebug().Write(STR_COMPONENT_NAME " included \"%s\".", FilePath.c_str());
+
+                Curr = (*Tail != '\0') ? Tail + 1 : Tail;
+                IsChanged = true;
+            }
+        }
+
+        Line = (*Tail != '\0') ? Tail + 1 : Tail;
+    }
+
+    if (IsChanged)
+        rewrittenText += Curr;
+
+    return IsChanged;
+}
+
+/// <summary>
+/// Replaces the names of sound files in string literals by the path of a local file.
+/// </summary>
+bool dependencies_t::ResolveSoundFiles(const char * text, std::string & rewrittenText, abort_callback & abortHandler)
+{
+    const char * Curr = text;
+    bool IsChanged = false;
+
+    for (const char * p = text; *p != '\0'; ++p)
+    {
+        if ((*p == ';') || ((p[0] == '/') && (p[1] == '/')))
+        {
+            p = SkipComment(p);
+
+            if (*p == '\0')
+                break;
+
+            continue;
+        }
+
+        if ((p[0] == '/') && (p[1] == '*'))
+        {
+            p = ::strstr(p + 2, "*/");
+
+            if (p == nullptr)
+                break;
+
+            ++p;
+
+            continue;
+        }
+
+        if (*p != '"')
+            continue;
+
+        const char * Head = p + 1;
+        const char * Tail = Head;
+
+        while ((*Tail != '\0') && (*Tail != '"') && (*Tail != '\n'))
+            ++Tail;
+
+        if (*Tail != '"')
+            break;
+
+        p = Tail;
+
+        const std::string FileName(Head, Tail);
+
+        if (!IsSoundFile(FileName))
+            continue;
+
+        const std::string FilePath = Combine(_Directory, FileName);
+
+        if (!filesystem::g_exists(FilePath.c_str(), abortHandler))
+            continue; // Let Csound search its own paths.
+
+        // Resolve every file only once, no matter how often it is used.
+        auto Item = _LocalPaths.find(FilePath);
+
+        if (Item == _LocalPaths.end())
+        {
+            std::string LocalPath = GetLocalPath(FilePath, abortHandler);
+
+            // Backslashes are escape characters in Csound strings.
+            std::replace(LocalPath.begin(), LocalPath.end(), '\\', '/');
+
+            Item = _LocalPaths.emplace(FilePath, std::move(LocalPath)).first;
+        }
+
+        const std::string & LocalPath = Item->second;
+
+        if (LocalPath == FileName)
+            continue;
+
+        rewrittenText.append(Curr, Head);
+        rewrittenText += LocalPath;
+
+        Curr = Tail;
+        IsChanged = true;
+    }
+
+    if (IsChanged)
+        rewrittenText += Curr;
+
+    return IsChanged;
+}
+
+/// <summary>
+/// Gets the path of a local copy of the specified file. Files on a local disk are queued for read-ahead unless only the information of the document is read.
+/// Other files are copied to a temporary file before this method returns, so they delay the opening of the document.
+/// </summary>
+std::string dependencies_t::GetLocalPath(const std::string & filePath, abort_callback & abortHandler)
+{
+    pfc::string8 NativePath;
+
+    if (foobar2000_io::extract_native_path(filePath.c_str(), NativePath))
+    {
+        if (_ReadAhead)
+            _ReadAheadFiles.push_back(msc::UTF8ToWide(NativePath.c_str(), NativePath.get_length()));
+
+        return NativePath.c_str();
+    }
+
+    // Copy the file to a temporary file with the same extension so the sound file library recognizes the format.
+    wchar_t TempPath[MAX_PATH];
+    wchar_t TempFileName[MAX_PATH];
+
+    if ((::GetTempPathW(_countof(TempPath), TempPath) == 0) || (::GetTempFileNameW(TempPath, L"fis", 0, TempFileName) == 0))
+        throw exception_io("Failed to create a temporary file");
+
+    std::wstring FilePath = TempFileName;
+
+    ::DeleteFileW(FilePath.c_str());
+
+    const std::string Extension = filePath.substr(filePath.rfind('.'));
+
+    FilePath += msc::UTF8ToWide(Extension.c_str(), Extension.size());
+
+    _TemporaryFiles.push_back(FilePath);
+
+    {
+        service_ptr_t<file> Src;
+
+        filesystem::g_open_read(Src, filePath.c_str(), abortHandler);
+
+        msc::file_stream_t Dst;
+
+        if (!Dst.Open(FilePath, true))
+            throw exception_io("Failed to create a temporary file");
+
+        std::vector<uint8_t> Buffer(BlockSize);
+
+        for (;;)
+        {
+            const size_t Size = Src->read(Buffer.data(), Buffer.size(), abortHandler);
+
+            if (Size == 0)
+                break;
+
+            Dst.Write(Buffer.data(), Size);
+        }
+    }
+
+    Log.AtDebug().Write(STR_COMPONENT_NAME " copied \"%s\" to a temporary file.", filePath.c_str());
+
+    return msc::WideToUTF8(FilePath);
+}
+
+/// <summary>
+/// Reads the start of the local sound files one after the other so they are in the system cache when Csound opens them. Runs on a background thread.
+/// </summary>
+void dependencies_t::ReadAhead(std::stop_token stopToken, const std::vector<std::wstring> & filePaths) noexcept
+{
+    try
+    {
+        std::vector<uint8_t> Buffer(BlockSize);
+
+        uint64_t TotalRemaining = MaxTotalReadAheadSize;
+
+        for (const auto & FilePath : filePaths)
+        {
+            try
+            {
+                msc::file_stream_t Stream;
+
+                Stream.Open(FilePath);
+
+                for (uint64_t Remaining = std::min({ fs::file_size(FilePath), MaxReadAheadSize, TotalRemaining }); Remaining != 0;)
+                {
+                    if (stopToken.stop_requested())
+                        return;
+
+                    const uint64_t Size = std::min(Remaining, (uint64_t) Buffer.size());
+
+                    Stream.Read(Buffer.data(), Size);
+
+                    Remaining      -= Size;
+                    TotalRemaining -= Size;
+                }
+            }
+            catch (...)
+            {
+                // Read-ahead is an optimization only. Csound reports any real problem with the file.
+            }
+
+            if (TotalRemaining == 0)
+                break;
+        }
+    }
+    catch (...)
+    {
+    }
+}
+
+/// <summary>
+/// Reads a text file through the foobar2000 file system.
+/// </summary>
+std::string dependencies_t::ReadText(const std::string & filePath, abort_callback & abortHandler) const
+{
+    service_ptr_t<file> File;
+
+    filesystem::g_open_read(File, filePath.c_str(), abortHandler);
+
+    std::string Text((size_t) File->get_size_ex(abortHandler), '\0');
+
+    File->read_object(Text.data(), Text.size(), abortHandler);
+
+    return Text;
+}
+
+/// <summary>
+/// Combines a directory and a file name. Absolute file names are returned unchanged.
+/// </summary>
+std::string dependencies_t::Combine(const std::string & directory, const std::string & fileName)
+{
+    if (fileName.find("://") != std::string::npos)
+        return fileName;
+
+    if (((fileName.size() > 1) && (fileName[1] == ':')) || fileName.starts_with("\\\\") || fileName.starts_with("//"))
+        return "file://" + fileName;
+
+    std::string FileName = fileName;
+
+    std::replace(FileName.begin(), FileName.end(), '/', '\\');
+
+    return directory + "\\" + FileName;
+}
+
+/// <summary>
+/// Returns a pointer to the end of the line of a comment.
+/// </summary>
+static const char * SkipComment(const char * text) noexcept
+{
+    while ((*text != '\0') && (*text != '\n'))
+        ++text;
+
+    return text;
+}
+
+/// <summary>
+/// Returns true if the file name has the extension of a sound file format that Csound can read.
+/// </summary>
+static bool IsSoundFile(const std::string & fileName) noexcept
+{
+    const size_t Dot = fileName.rfind('.');
+
+    if ((Dot == std::string::npos) || (fileName.find('\n') != std::string::npos))
+        return false;
+
+    return msc::IsOneOf(fileName.c_str() + Dot + 1, { "wav", "wave", "w64", "aif", "aiff", "aifc", "flac", "ogg", "opus", "mp3", "caf", "au", "snd", "sd2" });
+}
@@ -0,0 +1,52 @@
+
+/** $VER: Dependencies.h (2026.10.19) P. Stuer - Resolves the files a CSD depends on through the foobar2000 file system **/
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Resolves the files a Csound document depends on through the foobar2000 file system, so they can be located in archives or on remote locations.
+/// Included files are inlined. Sound files are replaced by their absolute path: files that are not on a local disk are copied to a temporary file first,
+/// the start of local files is read ahead on a background thread so streaming opcodes like diskin2 find it in the system cache.
+/// </summary>
+class dependencies_t
+{
+public:
+    dependencies_t(const char * documentPath, bool readAhead);
+
+    dependencies_t(const dependencies_t &) = delete;
+    dependencies_t & operator=(const dependencies_t &) = delete;
+
+    ~dependencies_t() noexcept;
+
+    bool Resolve(const char * text, std::string & rewrittenText, abort_callback & abortHandler);
+
+    static std::string Combine(const std::string & directory, const std::string & fileName);
+
+private:
+    bool InlineIncludes(const std::string & directory, const char * text, std::string & rewrittenText, int depth, abort_callback & abortHandler);
+    bool ResolveSoundFiles(const char * text, std::string & rewrittenText, abort_callback & abortHandler);
+
+    std::string GetLocalPath(const std::string & filePath, abort_callback & abortHandler);
+    std::string ReadText(const std::string & filePath, abort_callback & abortHandler) const;
+
+    static void ReadAhead(std::stop_token stopToken, const std::vector<std::wstring> & filePaths) noexcept;
+
+private:
+    std::string _Directory;
+    bool _ReadAhead;                                    // False when only the information of the document is read
+
+    std::map<std::string, std::string> _LocalPaths;    // Local path of each resolved sound file
+    std::vector<std::wstring> _TemporaryFiles;
+    std::vector<std::wstring> _ReadAheadFiles;          // Local sound files that are read ahead, in order of appearance
+    std::jthread _ReadAheadThread;
+
+    static const int MaxIncludeDepth = 16;
+    static const size_t BlockSize = 4 * 1024 * 1024;
+    static const uint64_t MaxReadAheadSize = 16 * 1024 * 1024;         // Number of bytes read ahead from the start of each file
+    static const uint64_t MaxTotalReadAheadSize = 64 * 1024 * 1024;    // Number of bytes read ahead from all files
+};
@@ -0,0 +1,663 @@
+
+/** $VER: Expression.cpp (2026.10.19) P. Stuer - Expression language compiled to register-based bytecode **/
+
+#include "pch.h"
+
+#include "Expression.h"
+
+#include <numbers>
+
+#pragma hdrstop
+
+/// <summary>
+/// Compiles the specified expression.
+/// </summary>
+void expression_t::Compile(const std::string & text, double sampleRate)
+{
+    _SampleRate = sampleRate;
+
+    _Text = text.c_str();
+    _Curr = _Text;
+
+    _Nodes.clear();
+    _NodeMap.clear();
+
+    _Root = ParseOr();
+
+    SkipWhitespace();
+
+    if (*_Curr != '\0')
+        Fail("Unexpected character");
+
+    Generate();
+}
+
+/// <summary>
+/// Evaluates the expression for a block of consecutive frames of one channel. The frame count must not exceed BlockSize.
+/// </summary>
+void expression_t::Evaluate(uint64_t frameIndex, uint32_t channel, size_t frameCount, double * out) noexcept
+{
+    if (_FrameRegister != NoRegister)
+    {
+        double * r = &_Registers[_FrameRegister * BlockSize];
+
+        for (size_t i = 0; i < frameCount; ++i)
+            r[i] = (double) (frameIndex + i);
+    }
+
+    if (_ChannelRegister != NoRegister)
+    {
+        double * r = &_Registers[_ChannelRegister * BlockSize];
+
+        std::fill(r, r + frameCount, (double) channel);
+    }
+
+    double * Registers = _Registers.data();
+
+    for (const auto & i : _Instructions)
+        Execute(i.Op, Registers + i.Dst * BlockSize, Registers + i.A * BlockSize, Registers + i.B * BlockSize, Registers + i.C * BlockSize, frameCount);
+
+    ::memcpy(out, Registers + _ResultRegister * BlockSize, frameCount * sizeof(*out));
+}
+
+#pragma region Parser
+
+/// <summary>
+/// or := and { "||" and }
+/// </summary>
+uint32_t expression_t::ParseOr()
+{
+    uint32_t a = ParseAnd();
+
+    while (Accept("||"))
+        a = AddNode(opcode_t::Or, a, ParseAnd());
+
+    return a;
+}
+
+/// <summary>
+/// and := comparison { "&&" comparison }
+/// </summary>
+uint32_t expression_t::ParseAnd()
+{
+    uint32_t a = ParseComparison();
+
+    while (Accept("&&"))
+        a = AddNode(opcode_t::And, a, ParseComparison());
+
+    return a;
+}
+
+/// <summary>
+/// comparison := sum { ("<" | "<=" | ">" | ">=" | "==" | "!=") sum }
+/// </summary>
+uint32_t expression_t::ParseComparison()
+{
+    uint32_t a = ParseSum();
+
+    for (;;)
+    {
+        if (Accept("<="))
+            a = AddNode(opcode_t::Le, a, ParseSum());
+        else
+        if (Accept(">="))
+            a = AddNode(opcode_t::Ge, a, ParseSum());
+        else
+        if (Accept("=="))
+            a = AddNode(opcode_t::Eq, a, ParseSum());
+        else
+        if (Accept("!="))
+            a = AddNode(opcode_t::Ne, a, ParseSum());
+        else
+        if (Accept("<"))
+            a = AddNode(opcode_t::Lt, a, ParseSum());
+        else
+        if (Accept(">"))
+            a = AddNode(opcode_t::Gt, a, ParseSum());
+        else
+            return a;
+    }
+}
+
+/// <summary>
+/// sum := product { ("+" | "-") product }
+/// </summary>
+uint32_t expression_t::ParseSum()
+{
+    uint32_t a = ParseProduct();
+
+    for (;;)
+    {
+        if (Accept("+"))
+            a = AddNode(opcode_t::Add, a, ParseProduct());
+        else
+        if (Accept("-"))
+            a = AddNode(opcode_t::Sub, a, ParseProduct());
+        else
+            return a;
+    }
+}
+
+/// <summary>
+/// product := unary { ("*" | "/" | "%") unary }
+/// </summary>
+uint32_t expression_t::ParseProduct()
+{
+    uint32_t a = ParseUnary();
+
+    for (;;)
+    {
+        if (Accept("*"))
+            a = AddNode(opcode_t::Mul, a, ParseUnary());
+        else
+        if (Accept("/"))
+            a = AddNode(opcode_t::Div, a, ParseUnary());
+        else
+        if (Accept("%"))
+            a = AddNode(opcode_t::Mod, a, ParseUnary());
+        else
+            return a;
+    }
+}
+
+/// <summary>
+/// unary := ("-" | "+" | "!") unary | power
+/// </summary>
+uint32_t expression_t::ParseUnary()
+{
+    if (Accept("-"))
+        return AddNode(opcode_t::Neg, ParseUnary());
+
+    if (Accept("+"))
+        return ParseUnary();
+
+    if (Accept("!"))
+        return AddNode(opcode_t::Not, ParseUnary());
+
+    return ParsePower();
+}
+
+/// <summary>
+/// power := primary [ "^" unary ]
+/// </summary>
+uint32_t expression_t::ParsePower()
+{
+    uint32_t a = ParsePrimary();
+
+    if (Accept("^"))
+        return AddNode(opcode_t::Pow, a, ParseUnary());
+
+    return a;
+}
+
+/// <summary>
+/// primary := number | variable | constant | function "(" [ or { "," or } ] ")" | "(" or ")"
+/// </summary>
+uint32_t expression_t::ParsePrimary()
+{
+    static const function_t Functions[] =
+    {
+        { "sin",   opcode_t::Sin,   1, 1 }, { "cos",   opcode_t::Cos,   1, 1 }, { "tan",   opcode_t::Tan,   1, 1 },
+        { "asin",  opcode_t::Asin,  1, 1 }, { "acos",  opcode_t::Acos,  1, 1 }, { "atan",  opcode_t::Atan,  1, 1 }, { "atan2", opcode_t::Atan2, 2, 2 },
+        { "sinh",  opcode_t::Sinh,  1, 1 }, { "cosh",  opcode_t::Cosh,  1, 1 }, { "tanh",  opcode_t::Tanh,  1, 1 },
+        { "exp",   opcode_t::Exp,   1, 1 }, { "log",   opcode_t::Log,   1, 1 }, { "log10", opcode_t::Log10, 1, 1 }, { "log2",  opcode_t::Log2,  1, 1 },
+        { "sqrt",  opcode_t::Sqrt,  1, 1 }, { "abs",   opcode_t::Abs,   1, 1 }, { "sign",  opcode_t::Sign,  1, 1 },
+        { "floor", opcode_t::Floor, 1, 1 }, { "ceil",  opcode_t::Ceil,  1, 1 }, { "round", opcode_t::Round, 1, 1 }, { "frac",  opcode_t::Frac,  1, 1 },
+        { "min",   opcode_t::Min,   2, 2 }, { "max",   opcode_t::Max,   2, 2 }, { "clamp", opcode_t::Clamp, 3, 3 }, { "fmod",  opcode_t::Fmod,  2, 2 },
+        { "pow",   opcode_t::Pow,   2, 2 },
+        { "square",opcode_t::Square,1, 1 }, { "saw",   opcode_t::Saw,   1, 1 }, { "tri",   opcode_t::Tri,   1, 1 },
+        { "db",    opcode_t::dB,    1, 1 }, { "noise", opcode_t::Noise, 0, 1 },
+    };
+
+    SkipWhitespace();
+
+    if (Accept("("))
+    {
+        uint32_t a = ParseOr();
+
+        if (!Accept(")"))
+            Fail("Expected ')'");
+
+        return a;
+    }
+
+    if (std::isdigit((unsigned char) *_Curr) || (*_Curr == '.'))
+    {
+        char * End = nullptr;
+
+        double Value = ::strtod(_Curr, &End);
+
+        if (End == _Curr)
+            Fail("Invalid number");
+
+        _Curr = End;
+
+        return AddConst(Value);
+    }
+
+    if (!std::isalpha((unsigned char) *_Curr) && (*_Curr != '_'))
+        Fail("Expected a number, a variable or a function");
+
+    const char * Head = _Curr;
+
+    while (std::isalnum((unsigned char) *_Curr) || (*_Curr == '_'))
+        ++_Curr;
+
+    const std::string Name(Head, (size_t) (_Curr - Head));
+
+    if (Name == "t")
+        return AddNode(opcode_t::Div, AddNode(opcode_t::Frame), AddConst(_SampleRate));
+
+    if (Name == "n")
+        return AddNode(opcode_t::Frame);
+
+    if (Name == "ch")
+        return AddNode(opcode_t::Channel);
+
+    if (Name == "sr")
+        return AddConst(_SampleRate);
+
+    if (Name == "pi")
+        return AddConst(std::numbers::pi);
+
+    if (Name == "tau")
+        return AddConst(2. * std::numbers::pi);
+
+    if (Name == "e")
+        return AddConst(std::numbers::e);
+
+    for (const auto & Function : Functions)
+    {
+        if (Name != Function.Name)
+            continue;
+
+        if (!Accept("("))
+            Fail("Expected '('");
+
+        uint32_t Args[3] = { };
+        size_t ArgCount = 0;
+
+        if (!Accept(")"))
+        {
+            do
+            {
+                if (ArgCount == Function.MaxArgs)
+                    Fail("Too many arguments");
+
+                Args[ArgCount++] = ParseOr();
+            }
+            while (Accept(","));
+
+            if (!Accept(")"))
+                Fail("Expected ')'");
+        }
+
+        if (ArgCount < Function.MinArgs)
+            Fail("Too few arguments");
+
+        // The noise is a function of the frame number and an optional seed so it is deterministic, seekable and can be shared.
+        if (Function.Op == opcode_t::Noise)
+            return AddNode(opcode_t::Noise, AddNode(opcode_t::Frame), (ArgCount != 0) ? Args[0] : AddConst(0.));
+
+        return AddNode(Function.Op, Args[0], Args[1], Args[2]);
+    }
+
+    _Curr = Head;
+
+    Fail("Unknown variable or function");
+}
+
+/// <summary>
+/// Skips white space.
+/// </summary>
+void expression_t::SkipWhitespace() noexcept
+{
+    while (std::isspace((unsigned char) *_Curr))
+        ++_Curr;
+}
+
+/// <summary>
+/// Consumes the specified token if it is next in the input.
+/// </summary>
+bool expression_t::Accept(const char * token) noexcept
+{
+    SkipWhitespace();
+
+    const size_t Length = ::strlen(token);
+
+    if (::strncmp(_Curr, token, Length) != 0)
+        return false;
+
+    _Curr += Length;
+
+    return true;
+}
+
+/// <summary>
+/// Throws a parse error.
+/// </summary>
+void expression_t::Fail(const char * message) const
+{
+    throw exception_io_data(msc::FormatText("%s at position %zu of expression \"%s\"", message, (size_t) (_Curr - _Text) + 1, _Text).c_str());
+}
+
+#pragma endregion
+
+#pragma region Simplifier
+
+/// <summary>
+/// Adds a node to the expression graph. Nodes with constant operands are evaluated immediately; identical nodes are shared.
+/// </summary>
+uint32_t expression_t::AddNode(opcode_t op, uint32_t a, uint32_t b, uint32_t c, double value)
+{
+    const size_t OperandCount = GetOperandCount(op);
+
+    const uint32_t Operands[3] = { a, b, c };
+
+    if (OperandCount != 0)
+    {
+        bool IsConstant = true;
+
+        for (size_t i = 0; i < OperandCount; ++i)
+            IsConstant &= (_Nodes[Operands[i]].Op == opcode_t::Const);
+
+        if (IsConstant)
+        {
+            const double x = _Nodes[a].Value;
+            const double y = (OperandCount > 1) ? _Nodes[b].Value : 0.;
+            const double z = (OperandCount > 2) ? _Nodes[c].Value : 0.;
+
+            return AddConst(Apply(op, x, y, z));
+        }
+    }
+
+    if (OperandCount < 3) c = 0;
+    if (OperandCount < 2) b = 0;
+    if (OperandCount < 1) a = 0;
+
+    // Normalize the operand order of commutative operations so more subexpressions can be shared.
+    switch (op)
+    {
+        case opcode_t::Add: case opcode_t::Mul: case opcode_t::Eq: case opcode_t::Ne:
+        case opcode_t::And: case opcode_t::Or: case opcode_t::Min: case opcode_t::Max:
+            if (a > b)
+                std::swap(a, b);
+            break;
+
+        default:
+            break;
+    }
+
+    const auto Key = std::make_tuple(op, a, b, c, std::bit_cast<uint64_t>(value));
+
+    auto Item = _NodeMap.find(Key);
+
+    if (Item != _NodeMap.end())
+        return Item->second;
+
+    if (_Nodes.size() >= (size_t) (NoRegister - 4))
+        Fail("Expression is too complex");
+
+    _Nodes.push_back({ op, a, b, c, value });
+
+    const uint32_t Index = (uint32_t) (_Nodes.size() - 1);
+
+    _NodeMap[Key] = Index;
+
+    return Index;
+}
+
+/// <summary>
+/// Adds a constant to the expression graph.
+/// </summary>
+uint32_t expression_t::AddConst(double value)
+{
+    return AddNode(opcode_t::Const, 0, 0, 0, value);
+}
+
+#pragma endregion
+
+#pragma region Code Generator
+
+/// <summary>
+/// Generates the bytecode. Registers of intermediate results are reused as soon as their value is no longer needed.
+/// </summary>
+void expression_t::Generate()
+{
+    const size_t NodeCount = _Nodes.size();
+
+    // Determine which nodes are used by the result and where they are used for the last time.
+    std::vector<bool> IsUsed(NodeCount);
+    std::vector<size_t> LastUse(NodeCount);
+
+    IsUsed[_Root] = true;
+
+    for (size_t i = NodeCount; i-- > 0;)
+    {
+        if (!IsUsed[i])
+            continue;
+
+        const node_t & Node = _Nodes[i];
+        const uint32_t Operands[3] = { Node.A, Node.B, Node.C };
+
+        for (size_t j = 0; j < GetOperandCount(Node.Op); ++j)
+        {
+            IsUsed[Operands[j]] = true;
+            LastUse[Operands[j]] = std::max(LastUse[Operands[j]], i);
+        }
+    }
+
+    std::vector<uint16_t> Registers(NodeCount, NoRegister);
+    std::vector<bool> IsPermanent;
+    std::vector<uint16_t> FreeRegisters;
+
+    _Instructions.clear();
+    _RegisterCount = 0;
+    _FrameRegister = _ChannelRegister = NoRegister;
+    _UsesChannel = false;
+
+    std::vector<std::pair<uint16_t, double>> Constants;
+
+    for (size_t i = 0; i < NodeCount; ++i)
+    {
+        if (!IsUsed[i])
+            continue;
+
+        const node_t & Node = _Nodes[i];
+
+        switch (Node.Op)
+        {
+            case opcode_t::Const:
+                Registers[i] = (uint16_t) _RegisterCount++;
+                Constants.push_back({ Registers[i], Node.Value });
+                break;
+
+            case opcode_t::Frame:
+                Registers[i] = _FrameRegister = (uint16_t) _RegisterCount++;
+                break;
+
+            case opcode_t::Channel:
+                Registers[i] = _ChannelRegister = (uint16_t) _RegisterCount++;
+                _UsesChannel = true;
+                break;
+
+            default:
+            {
+                uint16_t Dst;
+
+                if (!FreeRegisters.empty())
+                {
+                    Dst = FreeRegisters.back();
+                    FreeRegisters.pop_back();
+                }
+                else
+                    Dst = (uint16_t) _RegisterCount++;
+
+                const size_t OperandCount = GetOperandCount(Node.Op);
+
+                instruction_t Instruction = { Node.Op, Dst, Registers[Node.A], Registers[Node.A], Registers[Node.A] };
+
+                if (OperandCount > 1) Instruction.B = Registers[Node.B];
+                if (OperandCount > 2) Instruction.C = Registers[Node.C];
+
+                _Instructions.push_back(Instruction);
+
+                Registers[i] = Dst;
+
+                // Release the registers of the temporary operands that are not needed anymore.
+                const uint32_t Operands[3] = { Node.A, Node.B, Node.C };
+
+                for (size_t j = 0; j < OperandCount; ++j)
+                {
+                    const uint32_t Operand = Operands[j];
+                    const opcode_t OperandOp = _Nodes[Operand].Op;
+
+                    if ((LastUse[Operand] == i) && (OperandOp != opcode_t::Const) && (OperandOp != opcode_t::Frame) && (OperandOp != opcode_t::Channel))
+                    {
+                        if (std::find(FreeRegisters.begin(), FreeRegisters.end(), Registers[Operand]) == FreeRegisters.end())
+                            FreeRegisters.push_back(Registers[Operand]);
+                    }
+                }
+            }
+        }
+    }
+
+    _ResultRegister = Registers[_Root];
+
+    _Registers.assign(_RegisterCount * BlockSize, 0.);
+
+    for (const auto & [Register, Value] : Constants)
+        std::fill_n(_Registers.begin() + (ptrdiff_t) (Register * BlockSize), BlockSize, Value);
+}
+
+/// <summary>
+/// Gets the number of operands of an operation.
+/// </summary>
+size_t expression_t::GetOperandCount(opcode_t op) noexcept
+{
+    switch (op)
+    {
+        case opcode_t::Const: case opcode_t::Frame: case opcode_t::Channel:
+            return 0;
+
+        case opcode_t::Add: case opcode_t::Sub: case opcode_t::Mul: case opcode_t::Div: case opcode_t::Mod: case opcode_t::Pow:
+        case opcode_t::Lt: case opcode_t::Le: case opcode_t::Gt: case opcode_t::Ge: case opcode_t::Eq: case opcode_t::Ne:
+        case opcode_t::And: case opcode_t::Or:
+        case opcode_t::Atan2: case opcode_t::Min: case opcode_t::Max: case opcode_t::Fmod: case opcode_t::Noise:
+            return 2;
+
+        case opcode_t::Clamp:
+            return 3;
+
+        default:
+            return 1;
+    }
+}
+
+/// <summary>
+/// Applies an operation to scalar operands. Used for constant folding.
+/// </summary>
+double expression_t::Apply(opcode_t op, double a, double b, double c) noexcept
+{
+    double Result = 0.;
+
+    Execute(op, &Result, &a, &b, &c, 1);
+
+    return Result;
+}
+
+/// <summary>
+/// Executes an operation on a block of values. Every operation is a simple loop the compiler can vectorize.
+/// </summary>
+void expression_t::Execute(opcode_t op, double * __restrict d, const double * __restrict a, const double * __restrict b, const double * __restrict c, size_t n) noexcept
+{
+    #define UNARY(f)   for (size_t i = 0; i < n; ++i) { const double x = a[i]; d[i] = (f); } break
+    #define BINARY(f)  for (size_t i = 0; i < n; ++i) { const double x = a[i], y = b[i]; d[i] = (f); } break
+
+    switch (op)
+    {
+        case opcode_t::Neg:    UNARY(-x);
+        case opcode_t::Not:    UNARY((x == 0.) ? 1. : 0.);
+
+        case opcode_t::Add:    BINARY(x + y);
+        case opcode_t::Sub:    BINARY(x - y);
+        case opcode_t::Mul:    BINARY(x * y);
+        case opcode_t::Div:    BINARY(x / y);
+        case opcode_t::Mod:    BINARY(x - y * std::floor(x / y));
+        case opcode_t::Pow:    BINARY(std::pow(x, y));
+
+        case opcode_t::Lt:     BINARY((x <  y) ? 1. : 0.);
+        case opcode_t::Le:     BINARY((x <= y) ? 1. : 0.);
+        case opcode_t::Gt:     BINARY((x >  y) ? 1. : 0.);
+        case opcode_t::Ge:     BINARY((x >= y) ? 1. : 0.);
+        case opcode_t::Eq:     BINARY((x == y) ? 1. : 0.);
+        case opcode_t::Ne:     BINARY((x != y) ? 1. : 0.);
+        case opcode_t::And:    BINARY(((x != 0.) && (y != 0.)) ? 1. : 0.);
+        case opcode_t::Or:     BINARY(((x != 0.) || (y != 0.)) ? 1. : 0.);
+
+        case opcode_t::Sin:    UNARY(std::sin(x));
+        case opcode_t::Cos:    UNARY(std::cos(x));
+        case opcode_t::Tan:    UNARY(std::tan(x));
+        case opcode_t::Asin:   UNARY(std::asin(x));
+        case opcode_t::Acos:   UNARY(std::acos(x));
+        case opcode_t::Atan:   UNARY(std::atan(x));
+        case opcode_t::Atan2:  BINARY(std::atan2(x, y));
+        case opcode_t::Sinh:   UNARY(std::sinh(x));
+        case opcode_t::Cosh:   UNARY(std::cosh(x));
+        case opcode_t::Tanh:   UNARY(std::tanh(x));
+
+        case opcode_t::Exp:    UNARY(std::exp(x));
+        case opcode_t::Log:    UNARY(std::log(x));
+        case opcode_t::Log10:  UNARY(std::log10(x));
+        case opcode_t::Log2:   UNARY(std::log2(x));
+        case opcode_t::Sqrt:   UNARY(std::sqrt(x));
+        case opcode_t::Abs:    UNARY(std::abs(x));
+        case opcode_t::Floor:  UNARY(std::floor(x));
+        case opcode_t::Ceil:   UNARY(std::ceil(x));
+        case opcode_t::Round:  UNARY(std::round(x));
+        case opcode_t::Frac:   UNARY(x - std::floor(x));
+        case opcode_t::Sign:   UNARY((x > 0.) ? 1. : ((x < 0.) ? -1. : 0.));
+
+        case opcode_t::Min:    BINARY(std::min(x, y));
+        case opcode_t::Max:    BINARY(std::max(x, y));
+        case opcode_t::Fmod:   BINARY(std::fmod(x, y));
+
+        case opcode_t::Clamp:
+        {
+            for (size_t i = 0; i < n; ++i)
+                d[i] = std::min(std::max(a[i], b[i]), c[i]);
+            break;
+        }
+
+        // Periodic waveforms with a period of 1.
+        case opcode_t::Square: UNARY(((x - std::floor(x)) < .5) ? 1. : -1.);
+        case opcode_t::Saw:    UNARY(2. * (x - std::floor(x)) - 1.);
+        case opcode_t::Tri:    UNARY(4. * std::abs((x - .25) - std::floor(x - .25) - .5) - 1.);
+
+        case opcode_t::dB:     UNARY(std::pow(10., x / 20.));
+
+        // White noise between -1 and 1 derived from the frame number and the seed (SplitMix64).
+        case opcode_t::Noise:
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                uint64_t z = ((uint64_t) a[i] * 0x9E3779B97F4A7C15ull) ^ std::bit_cast<uint64_t>(b[i]);
+
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+                z =  z ^ (z >> 31);
+
+                d[i] = (double) (z >> 11) * (2. / 9007199254740992.) - 1.;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    #undef BINARY
+    #undef UNARY
+}
+
+#pragma endregion
@@ -0,0 +1,119 @@
+
+/** $VER: Expression.h (2026.10.19) P. Stuer - Expression language compiled to register-based bytecode **/
+
+#pragma once
+
+#include <bit>
+#include <map>
+#include <tuple>
+#include <vector>
+
+/// <summary>
+/// Implements a small expression language that describes a signal as a function of time, e.g. "0.5 * sin(2 * pi * 440 * t) * (t < 1)".
+/// The expression is parsed once, simplified using constant folding and common subexpression elimination, and compiled to a register-based bytecode that is evaluated a block of samples at a time.
+/// </summary>
+class expression_t
+{
+public:
+    expression_t() noexcept : _SampleRate(44100.), _Text(), _Curr(), _Root(), _RegisterCount(), _ResultRegister(), _FrameRegister(NoRegister), _ChannelRegister(NoRegister), _UsesChannel() { }
+
+    void Compile(const std::string & text, double sampleRate);
+
+    /// <summary>
+    /// Evaluates the expression for a block of consecutive frames of one channel. The frame count must not exceed BlockSize.
+    /// </summary>
+    void Evaluate(uint64_t frameIndex, uint32_t channel, size_t frameCount, double * out) noexcept;
+
+    /// <summary>
+    /// Returns true if the result depends on the channel number.
+    /// </summary>
+    bool UsesChannel() const noexcept { return _UsesChannel; }
+
+    size_t GetInstructionCount() const noexcept { return _Instructions.size(); }
+    size_t GetRegisterCount() const noexcept { return _RegisterCount; }
+
+    static const size_t BlockSize = 256;
+
+private:
+    enum class opcode_t : uint8_t
+    {
+        Const, Frame, Channel,
+
+        Neg, Not,
+        Add, Sub, Mul, Div, Mod, Pow,
+        Lt, Le, Gt, Ge, Eq, Ne, And, Or,
+
+        Sin, Cos, Tan, Asin, Acos, Atan, Atan2, Sinh, Cosh, Tanh,
+        Exp, Log, Log10, Log2, Sqrt, Abs, Floor, Ceil, Round, Frac, Sign,
+        Min, Max, Clamp, Fmod,
+        Square, Saw, Tri, dB, Noise,
+    };
+
+    struct node_t
+    {
+        opcode_t Op;
+        uint32_t A, B, C;
+        double Value;
+    };
+
+    struct instruction_t
+    {
+        opcode_t Op;
+        uint16_t Dst, A, B, C;
+    };
+
+    struct function_t
+    {
+        const char * Name;
+        opcode_t Op;
+        size_t MinArgs;
+        size_t MaxArgs;
+    };
+
+    // Parser
+    uint32_t ParseOr();
+    uint32_t ParseAnd();
+    uint32_t ParseComparison();
+    uint32_t ParseSum();
+    uint32_t ParseProduct();
+    uint32_t ParseUnary();
+    uint32_t ParsePower();
+    uint32_t ParsePrimary();
+
+    void SkipWhitespace() noexcept;
+    bool Accept(const char * token) noexcept;
+    [[noreturn]] void Fail(const char * message) const;
+
+    // Simplifier
+    uint32_t AddNode(opcode_t op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0, double value = 0.);
+    uint32_t AddConst(double value);
+
+    // Code generator
+    void Generate();
+
+    static size_t GetOperandCount(opcode_t op) noexcept;
+    static double Apply(opcode_t op, double a, double b, double c) noexcept;
+    static void Execute(opcode_t op, double * d, const double * a, const double * b, const double * c, size_t n) noexcept;
+
+private:
+    double _SampleRate;
+
+    // Parser state
+    const char * _Text;
+    const char * _Curr;
+
+    // Expression graph. Operands always precede the node that uses them.
+    std::vector<node_t> _Nodes;
+    std::map<std::tuple<opcode_t, uint32_t, uint32_t, uint32_t, uint64_t>, uint32_t> _NodeMap;
+    uint32_t _Root;
+
+    // Bytecode
+    std::vector<instruction_t> _Instructions;
+    std::vector<double> _Registers;         // Register r occupies BlockSize values starting at r * BlockSize.
+    size_t _RegisterCount;
+    uint16_t _ResultRegister;
+    uint16_t _FrameRegister, _ChannelRegister;
+    bool _UsesChannel;
+
+    static const uint16_t NoRegister = 0xFFFF;
+};
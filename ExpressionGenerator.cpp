@@ -0,0 +1,86 @@
+
+/** $VER: ExpressionGenerator.cpp (2026.10.19) P. Stuer - Generates a signal described by an expression **/
+
+#include "pch.h"
+
+#include "ExpressionGenerator.h"
+#include "SignalDocument.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+static_assert(sizeof(audio_sample) == sizeof(double), "sizeof(audio_sample) != sizeof(double)");
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+expression_generator_t::expression_generator_t(const signal_document_t & document) : native_generator_t(document), _Block(expression_t::BlockSize), _Position()
+{
+    const std::string Text = document.GetString("expression");
+
+    if (Text.empty())
+        throw exception_io_data("Signal document does not specify an expression");
+
+    _Expression.Compile(Text, (double) _SampleRate);
+
+    // The expression determines the level of the signal unless a level is specified explicitly.
+    _Gain = document.Has("level") ? _Level : 1.;
+
+    Log.AtInfo().Write(STR_COMPONENT_NAME " compiled expression to %zu instructions using %zu registers.", _Expression.GetInstructionCount(), _Expression.GetRegisterCount());
+}
+
+/// <summary>
+/// Returns true if the specified name identifies one of the signals of this generator.
+/// </summary>
+bool expression_generator_t::IsOurGenerator(const std::string & name) noexcept
+{
+    return msc::IsOneOf(name.c_str(), { "expression" });
+}
+
+/// <summary>
+/// Adds generator specific info tags.
+/// </summary>
+void expression_generator_t::GetInfo(file_info & fileInfo) const noexcept
+{
+    fileInfo.info_set_int("fis_instruction_count", (int64_t) _Expression.GetInstructionCount());
+}
+
+/// <summary>
+/// Generates the specified number of interleaved frames at the current position.
+/// </summary>
+void expression_generator_t::Generate(audio_sample * data, size_t frameCount) noexcept
+{
+    double * Block = _Block.data();
+
+    while (frameCount != 0)
+    {
+        const size_t n = std::min(frameCount, expression_t::BlockSize);
+
+        if (_Expression.UsesChannel())
+        {
+            for (uint32_t j = 0; j < _ChannelCount; ++j)
+            {
+                _Expression.Evaluate(_Position, j, n, Block);
+
+                for (size_t i = 0; i < n; ++i)
+                    data[i * _ChannelCount + j] = Block[i] * _Gain;
+            }
+        }
+        else
+        {
+            // Evaluate the expression once and copy the result to all channels.
+            _Expression.Evaluate(_Position, 0, n, Block);
+
+            for (size_t i = 0; i < n; ++i)
+                for (uint32_t j = 0; j < _ChannelCount; ++j)
+                    data[i * _ChannelCount + j] = Block[i] * _Gain;
+        }
+
+        data += n * _ChannelCount;
+
+        _Position += n;
+        frameCount -= n;
+    }
+}
@@ -0,0 +1,37 @@
+
+/** $VER: ExpressionGenerator.h (2026.10.19) P. Stuer - Generates a signal described by an expression **/
+
+#pragma once
+
+#include "Generator.h"
+#include "Expression.h"
+
+#include <vector>
+
+/// <summary>
+/// Generates a signal described by an expression of the time (t), the frame number (n) and the channel number (ch).
+/// </summary>
+class expression_generator_t : public native_generator_t
+{
+public:
+    expression_generator_t(const signal_document_t & document);
+
+    static bool IsOurGenerator(const std::string & name) noexcept;
+
+    void GetInfo(file_info & fileInfo) const noexcept override;
+
+protected:
+    void Generate(audio_sample * data, size_t frameCount) noexcept override;
+
+    void SetPosition(uint64_t frameIndex) noexcept override
+    {
+        _Position = frameIndex;
+    }
+
+private:
+    expression_t _Expression;
+    std::vector<double> _Block;
+
+    uint64_t _Position;
+    double _Gain;
+};
@@ -0,0 +1,118 @@
+
+/** $VER: FFT.cpp (2026.10.19) P. Stuer - Radix-2 Fast Fourier Transform **/
+
+#include "pch.h"
+
+#include "FFT.h"
+
+#include <numbers>
+
+#pragma hdrstop
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+fft_t::fft_t(size_t size) : _Size(size)
+{
+    if ((size < 2) || !std::has_single_bit(size))
+        throw exception_io_data("FFT size must be a power of 2");
+
+    _Twiddles.resize(size / 2);
+
+    for (size_t i = 0; i < size / 2; ++i)
+        _Twiddles[i] = std::polar(1., -2. * std::numbers::pi * (double) i / (double) size);
+
+    const int Bits = std::countr_zero(size);
+
+    _BitReversed.resize(size);
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        uint32_t r = 0;
+
+        for (int b = 0; b < Bits; ++b)
+            r |= (uint32_t) ((i >> b) & 1) << (Bits - 1 - b);
+
+        _BitReversed[i] = r;
+    }
+}
+
+/// <summary>
+/// Transforms the data in-place. The inverse transform is not normalized.
+/// </summary>
+void fft_t::Transform(std::complex<double> * data, bool inverse) const noexcept
+{
+    for (size_t i = 0; i < _Size; ++i)
+    {
+        const size_t j = _BitReversed[i];
+
+        if (i < j)
+            std::swap(data[i], data[j]);
+    }
+
+    for (size_t Length = 2; Length <= _Size; Length <<= 1)
+    {
+        const size_t Half = Length / 2;
+        const size_t Stride = _Size / Length;
+
+        for (size_t i = 0; i < _Size; i += Length)
+        {
+            for (size_t k = 0; k < Half; ++k)
+            {
+                std::complex<double> w = _Twiddles[k * Stride];
+
+                if (inverse)
+                    w = std::conj(w);
+
+                const std::complex<double> a = data[i + k];
+                const std::complex<double> b = data[i + k + Half] * w;
+
+                data[i + k]        = a + b;
+                data[i + k + Half] = a - b;
+            }
+        }
+    }
+}
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+real_fft_t::real_fft_t(size_t size) : _Size(size), _FFT(size / 2)
+{
+    if (size < 4)
+        throw exception_io_data("Real FFT size must be at least 4");
+
+    _Twiddles.resize(size / 2);
+
+    for (size_t i = 0; i < size / 2; ++i)
+        _Twiddles[i] = std::polar(1., -2. * std::numbers::pi * (double) i / (double) size);
+
+    _Buffer.resize(size / 2);
+}
+
+/// <summary>
+/// Transforms the data. The even samples are packed in the real part and the odd samples in the imaginary part of a complex FFT. The spectra of both are separated afterwards.
+/// </summary>
+void real_fft_t::Transform(const double * data, std::complex<double> * out) noexcept
+{
+    const size_t Half = _Size / 2;
+
+    for (size_t i = 0; i < Half; ++i)
+        _Buffer[i] = { data[2 * i], data[2 * i + 1] };
+
+    _FFT.Transform(_Buffer.data(), false);
+
+    out[0]    = { _Buffer[0].real() + _Buffer[0].imag(), 0. };
+    out[Half] = { _Buffer[0].real() - _Buffer[0].imag(), 0. };
+
+    for (size_t k = 1; k < Half; ++k)
+    {
+        const std::complex<double> a = _Buffer[k];
+        const std::complex<double> b = std::conj(_Buffer[Half - k]);
+
+        const std::complex<double> Even = (a + b) * .5;
+        const std::complex<double> Odd  = (a - b) * std::complex<double>(0., -.5);
+
+        out[k] = Even + _Twiddles[k] * Odd;
+    }
+}
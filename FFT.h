@@ -0,0 +1,53 @@
+
+/** $VER: FFT.h (2026.10.19) P. Stuer - Radix-2 Fast Fourier Transform **/
+
+#pragma once
+
+#include <complex>
+#include <vector>
+
+/// <summary>
+/// Implements an in-place, iterative radix-2 complex FFT with precalculated twiddle factors.
+/// </summary>
+class fft_t
+{
+public:
+    fft_t(size_t size);
+
+    size_t Size() const noexcept { return _Size; }
+
+    /// <summary>
+    /// Transforms the data in-place. The inverse transform is not normalized.
+    /// </summary>
+    void Transform(std::complex<double> * data, bool inverse) const noexcept;
+
+private:
+    size_t _Size;
+
+    std::vector<std::complex<double>> _Twiddles;
+    std::vector<uint32_t> _BitReversed;
+};
+
+/// <summary>
+/// Implements the FFT of real data using a complex FFT of half the size.
+/// </summary>
+class real_fft_t
+{
+public:
+    real_fft_t(size_t size);
+
+    size_t Size() const noexcept { return _Size; }
+
+    /// <summary>
+    /// Transforms Size() real values into Size() / 2 + 1 complex values, from DC to the Nyquist frequency.
+    /// </summary>
+    void Transform(const double * data, std::complex<double> * out) noexcept;
+
+private:
+    size_t _Size;
+
+    fft_t _FFT;
+
+    std::vector<std::complex<double>> _Twiddles;
+    std::vector<std::complex<double>> _Buffer;
+};
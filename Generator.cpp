@@ -0,0 +1,223 @@
+
+/** $VER: Generator.cpp (2026.10.19) P. Stuer - Base classes of the signal generators **/
+
+#include "pch.h"
+
+#include "Generator.h"
+#include "SignalDocument.h"
+#include "Multitone.h"
+#include "ExpressionGenerator.h"
+#include "Oscillator.h"
+#include "ChannelPattern.h"
+#include "Burst.h"
+
+#pragma hdrstop
+
+/// <summary>
+/// Initializes a new instance with the parameters common to all native generators.
+/// </summary>
+native_generator_t::native_generator_t(const signal_document_t & document) : _FrameIndex()
+{
+    _SampleRate   = (uint32_t) document.GetInteger("sample_rate", 44100, 1000, 768000);
+    _ChannelCount = (uint32_t) document.GetInteger("channels", 2, 1, MaxChannelCount);
+
+    const std::string Layout = document.GetString("layout");
+
+    if (!Layout.empty())
+    {
+        _ChannelConfig = GetChannelConfig(Layout);
+
+        const uint32_t ChannelCount = (uint32_t) std::popcount(_ChannelConfig);
+
+        if (document.Has("channels") && (_ChannelCount != ChannelCount))
+            throw exception_io_data(msc::FormatText("Layout \"%s\" has %u channels instead of %u", Layout.c_str(), ChannelCount, _ChannelCount).c_str());
+
+        _ChannelCount = ChannelCount;
+    }
+    else
+    if (_ChannelCount > audio_chunk::defined_channel_count)
+        _ChannelConfig = (uint32_t) ((1ull << _ChannelCount) - 1); // All named speakers followed by unnamed channels.
+
+    const double Duration = document.GetDouble("duration", 0., 0., 86400. * 7.);
+
+    _FrameCount = (uint64_t) (Duration * _SampleRate + .5);
+
+    _Level = std::pow(10., document.GetDouble("level", -6., -200., 0.) / 20.);
+}
+
+/// <summary>
+/// Starts rendering.
+/// </summary>
+void native_generator_t::Start() noexcept
+{
+    Seek(0);
+}
+
+/// <summary>
+/// Moves the playback position to the specified frame.
+/// </summary>
+void native_generator_t::Seek(uint64_t frameIndex) noexcept
+{
+    if ((_FrameCount != 0) && (frameIndex > _FrameCount))
+        frameIndex = _FrameCount;
+
+    _FrameIndex = frameIndex;
+
+    SetPosition(frameIndex);
+}
+
+/// <summary>
+/// Renders an audio chunk.
+/// </summary>
+bool native_generator_t::Render(audio_chunk & audioChunk) noexcept
+{
+    size_t FrameCount = FramesPerChunk;
+
+    if (_FrameCount != 0)
+    {
+        if (_FrameIndex >= _FrameCount)
+            return false;
+
+        FrameCount = (size_t) std::min((uint64_t) FrameCount, _FrameCount - _FrameIndex);
+    }
+
+    audioChunk.set_data_size((t_size) FrameCount * _ChannelCount);
+
+    Generate(audioChunk.get_data(), FrameCount);
+
+    _FrameIndex += FrameCount;
+
+    audioChunk.set_srate(_SampleRate);
+
+    if (_ChannelConfig != 0)
+        audioChunk.set_channels(_ChannelCount, _ChannelConfig);
+    else
+        audioChunk.set_channels(_ChannelCount);
+
+    audioChunk.set_sample_count(FrameCount);
+
+    return true;
+}
+
+/// <summary>
+/// Gets the foobar2000 channel configuration of a speaker layout. The layout is either a name like "5.1" or "7.1.4" or a comma-separated list of speakers like "FL,FR,LFE".
+/// The order of the channels in the output is always the foobar2000 order, regardless of the order in the list.
+/// </summary>
+uint32_t native_generator_t::GetChannelConfig(const std::string & layout)
+{
+    static const std::pair<const char *, const char *> Layouts[] =
+    {
+        { "mono",   "FC" },
+        { "stereo", "FL,FR" },
+        { "2.1",    "FL,FR,LFE" },
+        { "3.0",    "FL,FR,FC" },
+        { "quad",   "FL,FR,BL,BR" },
+        { "5.0",    "FL,FR,FC,BL,BR" },
+        { "5.1",    "FL,FR,FC,LFE,BL,BR" },
+        { "6.1",    "FL,FR,FC,LFE,BC,SL,SR" },
+        { "7.1",    "FL,FR,FC,LFE,BL,BR,SL,SR" },
+        { "5.1.2",  "FL,FR,FC,LFE,BL,BR,TFL,TFR" },
+        { "5.1.4",  "FL,FR,FC,LFE,BL,BR,TFL,TFR,TBL,TBR" },
+        { "7.1.2",  "FL,FR,FC,LFE,BL,BR,SL,SR,TFL,TFR" },
+        { "7.1.4",  "FL,FR,FC,LFE,BL,BR,SL,SR,TFL,TFR,TBL,TBR" },
+        { "7.1.6",  "FL,FR,FC,LFE,BL,BR,SL,SR,TFL,TFC,TFR,TBL,TBC,TBR" },
+        { "9.1.6",  "FL,FR,FC,LFE,BL,BR,FLC,FRC,SL,SR,TFL,TFC,TFR,TBL,TBC,TBR" },
+        { "all",    "FL,FR,FC,LFE,BL,BR,FLC,FRC,BC,SL,SR,TC,TFL,TFC,TFR,TBL,TBC,TBR" },
+    };
+
+    static const std::pair<const char *, uint32_t> Speakers[] =
+    {
+        { "FL",  audio_chunk::channel_front_left },
+        { "FR",  audio_chunk::channel_front_right },
+        { "FC",  audio_chunk::channel_front_center },
+        { "LFE", audio_chunk::channel_lfe },
+        { "BL",  audio_chunk::channel_back_left },
+        { "BR",  audio_chunk::channel_back_right },
+        { "FLC", audio_chunk::channel_front_center_left },
+        { "FRC", audio_chunk::channel_front_center_right },
+        { "BC",  audio_chunk::channel_back_center },
+        { "SL",  audio_chunk::channel_side_left },
+        { "SR",  audio_chunk::channel_side_right },
+        { "TC",  audio_chunk::channel_top_center },
+        { "TFL", audio_chunk::channel_top_front_left },
+        { "TFC", audio_chunk::channel_top_front_center },
+        { "TFR", audio_chunk::channel_top_front_right },
+        { "TBL", audio_chunk::channel_top_back_left },
+        { "TBC", audio_chunk::channel_top_back_center },
+        { "TBR", audio_chunk::channel_top_back_right },
+    };
+
+    std::string SpeakerList = layout;
+
+    for (const auto & [Name, List] : Layouts)
+    {
+        if (msc::IsOneOf(layout.c_str(), { Name }))
+        {
+            SpeakerList = List;
+            break;
+        }
+    }
+
+    uint32_t ChannelConfig = 0;
+
+    for (size_t Head = 0; Head <= SpeakerList.size();)
+    {
+        size_t Tail = SpeakerList.find(',', Head);
+
+        if (Tail == std::string::npos)
+            Tail = SpeakerList.size();
+
+        std::string Name = SpeakerList.substr(Head, Tail - Head);
+
+        Name.erase(0, Name.find_first_not_of(" \t"));
+        Name.erase(Name.find_last_not_of(" \t") + 1);
+
+        uint32_t Speaker = 0;
+
+        for (const auto & Item : Speakers)
+        {
+            if (msc::IsOneOf(Name.c_str(), { Item.first }))
+            {
+                Speaker = Item.second;
+                break;
+            }
+        }
+
+        if ((Speaker == 0) || ((ChannelConfig & Speaker) != 0))
+            throw exception_io_data(msc::FormatText("Invalid or duplicate speaker \"%s\" in layout \"%s\"", Name.c_str(), layout.c_str()).c_str());
+
+        ChannelConfig |= Speaker;
+
+        Head = Tail + 1;
+    }
+
+    return ChannelConfig;
+}
+
+/// <summary>
+/// Creates the generator described by the specified signal document.
+/// </summary>
+std::unique_ptr<generator_t> CreateGenerator(const signal_document_t & document)
+{
+    const std::string Name = document.GetString("generator");
+
+    if (Name.empty())
+        throw exception_io_data("Signal document does not specify a generator");
+
+    if (multitone_t::IsOurGenerator(Name))
+        return std::make_unique<multitone_t>(document);
+
+    if (oscillator_t::IsOurGenerator(Name))
+        return std::make_unique<oscillator_t>(document);
+
+    if (channel_pattern_t::IsOurGenerator(Name))
+        return std::make_unique<channel_pattern_t>(document);
+
+    if (burst_t::IsOurGenerator(Name))
+        return std::make_unique<burst_t>(document);
+
+    if (expression_generator_t::IsOurGenerator(Name))
+        return std::make_unique<expression_generator_t>(document);
+
+    throw exception_io_data(msc::FormatText("Unknown generator \"%s\"", Name.c_str()).c_str());
+}
@@ -0,0 +1,97 @@
+
+/** $VER: Generator.h (2026.10.19) P. Stuer - Base classes of the signal generators **/
+
+#pragma once
+
+class signal_document_t;
+
+/// <summary>
+/// Represents a signal generator.
+/// </summary>
+class generator_t
+{
+public:
+    generator_t() noexcept : _SampleRate(), _ChannelCount(), _ChannelConfig(), _FrameCount() { }
+    virtual ~generator_t() { }
+
+    virtual void Start() = 0;
+    virtual bool Render(audio_chunk & audioChunk) noexcept = 0;
+    virtual void Stop() noexcept = 0;
+
+    /// <summary>
+    /// Moves the playback position to the specified frame.
+    /// </summary>
+    virtual void Seek(uint64_t) noexcept { }
+
+    /// <summary>
+    /// Gets the number of subsongs.
+    /// </summary>
+    virtual uint32_t GetSubsongCount() const noexcept { return 1; }
+
+    /// <summary>
+    /// Selects the subsong that is played after the next start.
+    /// </summary>
+    virtual void SelectSubsong(uint32_t) noexcept { }
+
+    /// <summary>
+    /// Gets the number of frames of the specified subsong, 0 if infinite.
+    /// </summary>
+    virtual uint64_t GetFrameCount(uint32_t) const noexcept { return _FrameCount; }
+
+    /// <summary>
+    /// Gets the name of the specified subsong, if it has one.
+    /// </summary>
+    virtual std::string GetSubsongName(uint32_t) const { return std::string(); }
+
+    /// <summary>
+    /// Adds generator specific info tags.
+    /// </summary>
+    virtual void GetInfo(file_info &) const noexcept { }
+
+    /// <summary>
+    /// Adds generator specific dynamic info tags. Returns true if the tags have changed.
+    /// </summary>
+    virtual bool GetDynamicInfo(file_info &) noexcept { return false; }
+
+public:
+    uint32_t _SampleRate;
+    uint32_t _ChannelCount;
+    uint32_t _ChannelConfig;    // foobar2000 channel configuration mask, 0 if the default for the channel count.
+    uint64_t _FrameCount;       // Total number of frames to generate, 0 if infinite.
+};
+
+/// <summary>
+/// Represents a signal generator that is implemented by the component itself.
+/// </summary>
+class native_generator_t : public generator_t
+{
+public:
+    native_generator_t(const signal_document_t & document);
+
+    void Start() noexcept override;
+    bool Render(audio_chunk & audioChunk) noexcept override;
+    void Stop() noexcept override { }
+    void Seek(uint64_t frameIndex) noexcept override;
+
+protected:
+    /// <summary>
+    /// Generates the specified number of interleaved frames at the current position.
+    /// </summary>
+    virtual void Generate(audio_sample * data, size_t frameCount) noexcept = 0;
+
+    /// <summary>
+    /// Moves the generator to the specified frame.
+    /// </summary>
+    virtual void SetPosition(uint64_t frameIndex) noexcept = 0;
+
+    static uint32_t GetChannelConfig(const std::string & layout);
+
+protected:
+    double _Level;              // Linear output level (1.0 = 0 dBFS)
+    uint64_t _FrameIndex;
+
+    static const size_t FramesPerChunk = 1024;
+    static const uint32_t MaxChannelCount = 32; // Width of the foobar2000 channel configuration mask. Channels beyond the 18 named speakers are unnamed.
+};
+
+std::unique_ptr<generator_t> CreateGenerator(const signal_document_t & document);
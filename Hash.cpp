@@ -0,0 +1,131 @@
+
+/** $VER: Hash.cpp (2026.10.19) P. Stuer - 64-bit xxHash (XXH64) **/
+
+#include "pch.h"
+
+#include "Hash.h"
+
+#pragma hdrstop
+
+static constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t Read64(const uint8_t * p) noexcept { uint64_t Value; ::memcpy(&Value, p, sizeof(Value)); return Value; }
+static inline uint32_t Read32(const uint8_t * p) noexcept { uint32_t Value; ::memcpy(&Value, p, sizeof(Value)); return Value; }
+
+static inline uint64_t Round(uint64_t accumulator, uint64_t value) noexcept
+{
+    accumulator += value * Prime2;
+    accumulator  = std::rotl(accumulator, 31);
+
+    return accumulator * Prime1;
+}
+
+static inline uint64_t Merge(uint64_t hash, uint64_t accumulator) noexcept
+{
+    hash ^= Round(0, accumulator);
+
+    return hash * Prime1 + Prime4;
+}
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+xxhash64_t::xxhash64_t(uint64_t seed) noexcept : _Accumulators { seed + Prime1 + Prime2, seed + Prime2, seed, seed - Prime1 }, _Seed(seed), _TotalSize(), _Buffer(), _BufferSize()
+{
+}
+
+/// <summary>
+/// Adds data to the hash.
+/// </summary>
+void xxhash64_t::Update(const void * data, size_t size) noexcept
+{
+    const uint8_t * p = (const uint8_t *) data;
+    const uint8_t * Tail = p + size;
+
+    _TotalSize += size;
+
+    // Complete a partial stripe first.
+    if (_BufferSize != 0)
+    {
+        const size_t n = std::min(size, sizeof(_Buffer) - _BufferSize);
+
+        ::memcpy(_Buffer + _BufferSize, p, n);
+
+        _BufferSize += n;
+        p += n;
+
+        if (_BufferSize < sizeof(_Buffer))
+            return;
+
+        for (size_t i = 0; i < 4; ++i)
+            _Accumulators[i] = Round(_Accumulators[i], Read64(_Buffer + i * 8));
+
+        _BufferSize = 0;
+    }
+
+    uint64_t v1 = _Accumulators[0], v2 = _Accumulators[1], v3 = _Accumulators[2], v4 = _Accumulators[3];
+
+    for (; p + 32 <= Tail; p += 32)
+    {
+        v1 = Round(v1, Read64(p));
+        v2 = Round(v2, Read64(p +  8));
+        v3 = Round(v3, Read64(p + 16));
+        v4 = Round(v4, Read64(p + 24));
+    }
+
+    _Accumulators[0] = v1; _Accumulators[1] = v2; _Accumulators[2] = v3; _Accumulators[3] = v4;
+
+    if (p < Tail)
+    {
+        _BufferSize = (size_t) (Tail - p);
+
+        ::memcpy(_Buffer, p, _BufferSize);
+    }
+}
+
+/// <summary>
+/// Gets the hash of the data that has been added so far.
+/// </summary>
+uint64_t xxhash64_t::Digest() const noexcept
+{
+    uint64_t Hash;
+
+    if (_TotalSize >= 32)
+    {
+        Hash = std::rotl(_Accumulators[0], 1) + std::rotl(_Accumulators[1], 7) + std::rotl(_Accumulators[2], 12) + std::rotl(_Accumulators[3], 18);
+
+        for (const auto Accumulator : _Accumulators)
+            Hash = Merge(Hash, Accumulator);
+    }
+    else
+        Hash = _Seed + Prime5;
+
+    Hash += _TotalSize;
+
+    const uint8_t * p = _Buffer;
+    const uint8_t * Tail = _Buffer + _BufferSize;
+
+    for (; p + 8 <= Tail; p += 8)
+        Hash = std::rotl(Hash ^ Round(0, Read64(p)), 27) * Prime1 + Prime4;
+
+    if (p + 4 <= Tail)
+    {
+        Hash = std::rotl(Hash ^ (Read32(p) * Prime1), 23) * Prime2 + Prime3;
+        p += 4;
+    }
+
+    for (; p < Tail; ++p)
+        Hash = std::rotl(Hash ^ (*p * Prime5), 11) * Prime1;
+
+    Hash ^= Hash >> 33;
+    Hash *= Prime2;
+    Hash ^= Hash >> 29;
+    Hash *= Prime3;
+    Hash ^= Hash >> 32;
+
+    return Hash;
+}
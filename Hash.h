@@ -0,0 +1,38 @@
+
+/** $VER: Hash.h (2026.10.19) P. Stuer - 64-bit xxHash (XXH64) **/
+
+#pragma once
+
+#include <cstdint>
+
+/// <summary>
+/// Implements the 64-bit xxHash algorithm (XXH64). Data can be added in any number of parts.
+/// </summary>
+class xxhash64_t
+{
+public:
+    xxhash64_t(uint64_t seed = 0) noexcept;
+
+    void Update(const void * data, size_t size) noexcept;
+    uint64_t Digest() const noexcept;
+
+    /// <summary>
+    /// Calculates the hash of a single block of data.
+    /// </summary>
+    static uint64_t Compute(const void * data, size_t size, uint64_t seed = 0) noexcept
+    {
+        xxhash64_t Hash(seed);
+
+        Hash.Update(data, size);
+
+        return Hash.Digest();
+    }
+
+private:
+    uint64_t _Accumulators[4];
+    uint64_t _Seed;
+    uint64_t _TotalSize;
+
+    uint8_t _Buffer[32];
+    size_t _BufferSize;
+};
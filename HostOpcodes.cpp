@@ -0,0 +1,214 @@
+
+/** $VER: HostOpcodes.cpp (2026.10.19) P. Stuer - Opcodes implemented by the component **/
+
+#include "pch.h"
+
+#include <plugin.h>
+
+#include "HostOpcodes.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#include <limits>
+#include <numbers>
+
+#pragma hdrstop
+
+/// <summary>
+/// Implements a sine oscillator: aout fis_osc kamp, kcps [, iphase]
+/// The phase is kept in double precision. The samples of a control cycle are generated by rotating 4 interleaved phasors, which are set up from the phase at the start of every control cycle so the rounding errors don't accumulate.
+/// </summary>
+struct fis_osc_t : csnd::Plugin<1, 3>
+{
+    int init()
+    {
+        _Phase = inargs[2] - std::floor(inargs[2]);
+        _Increment = std::numeric_limits<double>::quiet_NaN();
+
+        return OK;
+    }
+
+    int aperf()
+    {
+        MYFLT * Out = outargs(0);
+
+        const double Amplitude = inargs[0];
+        const double Increment = inargs[1] / csound->sr();
+
+        const uint32_t Count = nsmps - offset;
+
+        if (Count < Lanes * 2)
+        {
+            // Setting up the phasors costs more than calculating a few samples directly.
+            for (uint32_t i = 0; i < Count; ++i)
+                Out[offset + i] = Amplitude * std::sin(2. * std::numbers::pi * (_Phase + (double) i * Increment));
+        }
+        else
+        {
+            if (Increment != _Increment)
+                SetIncrement(Increment);
+
+            const double Angle = 2. * std::numbers::pi * _Phase;
+
+            double Sin[Lanes];
+            double Cos[Lanes];
+
+            Sin[0] = Amplitude * std::sin(Angle);
+            Cos[0] = Amplitude * std::cos(Angle);
+
+            for (uint32_t j = 1; j < Lanes; ++j)
+            {
+                Sin[j] = Sin[j - 1] * _StepCos + Cos[j - 1] * _StepSin;
+                Cos[j] = Cos[j - 1] * _StepCos - Sin[j - 1] * _StepSin;
+            }
+
+            MYFLT * Data = Out + offset;
+            MYFLT * Tail = Out + nsmps;
+
+            for (; Data + Lanes <= Tail; Data += Lanes)
+            {
+                for (uint32_t j = 0; j < Lanes; ++j)
+                {
+                    Data[j] = Sin[j];
+
+                    const double NewSin = Sin[j] * _RotateCos + Cos[j] * _RotateSin;
+                    const double NewCos = Cos[j] * _RotateCos - Sin[j] * _RotateSin;
+
+                    Sin[j] = NewSin;
+                    Cos[j] = NewCos;
+                }
+            }
+
+            for (uint32_t j = 0; Data < Tail; ++Data, ++j)
+                *Data = Sin[j];
+        }
+
+        _Phase += (double) Count * Increment;
+        _Phase -= std::floor(_Phase);
+
+        return OK;
+    }
+
+    /// <summary>
+    /// Calculates the rotations of the phasors for a new frequency.
+    /// </summary>
+    void SetIncrement(double increment) noexcept
+    {
+        const double Step = 2. * std::numbers::pi * increment;
+
+        _StepSin = std::sin(Step);
+        _StepCos = std::cos(Step);
+
+        _RotateSin = std::sin(Step * Lanes);
+        _RotateCos = std::cos(Step * Lanes);
+
+        _Increment = increment;
+    }
+
+    double _Phase;
+    double _Increment;  // Phase increment the rotations were calculated for
+
+    double _StepSin;    // Rotation by one sample
+    double _StepCos;
+    double _RotateSin;  // Rotation of each phasor by the number of phasors
+    double _RotateCos;
+
+    static constexpr uint32_t Lanes = 4;
+};
+
+/// <summary>
+/// Implements a biquad filter with normalized coefficients: aout fis_biquad ain, kb0, kb1, kb2, ka1, ka2
+/// Uses the transposed direct form II with a double precision state.
+/// </summary>
+struct fis_biquad_t : csnd::Plugin<1, 6>
+{
+    int init()
+    {
+        _Z1 = _Z2 = 0.;
+
+        return OK;
+    }
+
+    int aperf()
+    {
+        MYFLT * Out = outargs(0);
+        const MYFLT * In = inargs(0);
+
+        const double b0 = inargs[1], b1 = inargs[2], b2 = inargs[3], a1 = inargs[4], a2 = inargs[5];
+
+        double z1 = _Z1, z2 = _Z2;
+
+        for (uint32_t i = offset; i < nsmps; ++i)
+        {
+            const double x = In[i];
+            const double y = b0 * x + z1;
+
+            z1 = b1 * x - a1 * y + z2;
+            z2 = b2 * x - a2 * y;
+
+            Out[i] = y;
+        }
+
+        _Z1 = z1;
+        _Z2 = z2;
+
+        return OK;
+    }
+
+    double _Z1, _Z2;
+};
+
+/// <summary>
+/// Implements a gain that changes without zipper noise: aout fis_gain ain, kgain
+/// The gain is interpolated linearly from the value of the previous control cycle to the new value.
+/// </summary>
+struct fis_gain_t : csnd::Plugin<1, 2>
+{
+    int init()
+    {
+        _Gain = inargs[1];
+
+        return OK;
+    }
+
+    int aperf()
+    {
+        MYFLT * Out = outargs(0);
+        const MYFLT * In = inargs(0);
+
+        const double Gain = inargs[1];
+
+        if (Gain == _Gain)
+        {
+            for (uint32_t i = offset; i < nsmps; ++i)
+                Out[i] = In[i] * Gain;
+        }
+        else
+        {
+            const double Step = (Gain - _Gain) / (double) (nsmps - offset);
+            const double Start = _Gain + Step - (double) offset * Step;
+
+            for (uint32_t i = offset; i < nsmps; ++i)
+                Out[i] = In[i] * (Start + (double) i * Step);
+
+            _Gain = Gain;
+        }
+
+        return OK;
+    }
+
+    double _Gain;
+};
+
+/// <summary>
+/// Registers the opcodes of the component with a Csound instance. Scripts use them by name.
+/// </summary>
+void RegisterHostOpcodes(CSOUND * csound) noexcept
+{
+    auto Csound = (csnd::Csound *) csound;
+
+    csnd::plugin<fis_osc_t>   (Csound, "fis_osc",    "a", "kko",    csnd::thread::ia);
+    csnd::plugin<fis_biquad_t>(Csound, "fis_biquad", "a", "akkkkk", csnd::thread::ia);
+    csnd::plugin<fis_gain_t>  (Csound, "fis_gain",   "a", "ak",     csnd::thread::ia);
+}
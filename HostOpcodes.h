@@ -0,0 +1,8 @@
+
+/** $VER: HostOpcodes.h (2026.10.19) P. Stuer - Opcodes implemented by the component **/
+
+#pragma once
+
+#include <csound.h>
+
+void RegisterHostOpcodes(CSOUND * csound) noexcept;
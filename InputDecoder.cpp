@@ -16,6 +16,11 @@
 #include "Log.h"
 
 #include "csound.h"
+#include "CSoundHeader.h"
+#include "SignalDocument.h"
+#include "Configuration.h"
+#include "OutputHash.h"
+#include "SpectrumVerifier.h"
 
 #pragma hdrstop
 
@@ -53,6 +58,19 @@ public:
         _File = file;
         _FilePath = filePath;
 
+        if (IsExpressionURL(filePath))
+        {
+            signal_document_t Document;
+
+            ParseExpressionURL(filePath, Document);
+
+            _Generator = CreateGenerator(Document);
+
+            _FileStats = filestats_invalid;
+
+            return;
+        }
+
         input_open_file_helper(_File, filePath, reason, abortHandler);
 
         {
@@ -62,6 +80,7 @@ public:
                 throw exception_io_unsupported_format("Invalid file size");
         }
 
+        if (IsSignalDocument(filePath) || IsExpressionDocument(filePath))
         {
             pfc::array_t<char> Data;
 
@@ -69,12 +88,23 @@ public:
 
             _File->read_object(Data.get_ptr(), Data.get_size(), abortHandler);
 
-            _Script = Data.get_ptr();
+            signal_document_t Document;
 
-            _CSound.Load(_Script);
-        }
+            if (IsSignalDocument(filePath))
+                Document.Parse(Data.get_ptr(), Data.get_size());
+            else
+            {
+                Document.Set("generator", "expression");
+                Document.Set("expression", std::string(Data.get_ptr(), Data.get_size()));
+            }
 
-        Log.AtInfo().Write(STR_COMPONENT_NAME " is using Csound %s.", _CSound.GetVersion().c_str());
+            if (msc::IsOneOf(Document.GetString("generator").c_str(), { "midi" }))
+                LoadMIDI(filePath, Document, reason, abortHandler);
+            else
+                _Generator = CreateGenerator(Document);
+        }
+        else
+            LoadCSD(filePath, reason, abortHandler);
     }
 
     static bool g_is_our_content_type(const char * contentType)
@@ -82,9 +112,9 @@ public:
         return ::stricmp_utf8(contentType, "audio/csd") == 0;
     }
 
-    static bool g_is_our_path(const char *, const char * extension)
+    static bool g_is_our_path(const char * filePath, const char * extension)
     {
-        return (::stricmp_utf8(extension, "csd") == 0);
+        return (::stricmp_utf8(extension, "csd") == 0) || (::stricmp_utf8(extension, "sig") == 0) || (::stricmp_utf8(extension, "expr") == 0) || IsExpressionURL(filePath) || IsCompressedDocument(filePath);
     }
 
     static GUID g_get_guid()
@@ -113,7 +143,7 @@ public:
 
     unsigned get_subsong_count()
     {
-        return 1;
+        return _Generator->GetSubsongCount();
     }
 
     t_uint32 get_subsong(unsigned subSongIndex)
@@ -124,16 +154,24 @@ public:
     /// <summary>
     /// Retrieves information about specified subsong.
     /// </summary>
-    void get_info(t_uint32, file_info & fileInfo, abort_callback &)
+    void get_info(t_uint32 subSongIndex, file_info & fileInfo, abort_callback &)
     {
-        fileInfo.set_length(0.); // Sets audio duration, in seconds (infinite)
+        const uint64_t FrameCount = _Generator->GetFrameCount(subSongIndex);
+
+        // Sets audio duration, in seconds (0 = infinite)
+        fileInfo.set_length((FrameCount != 0) ? (double) FrameCount / _Generator->_SampleRate : 0.);
+
+        const std::string Name = _Generator->GetSubsongName(subSongIndex);
+
+        if (!Name.empty())
+            fileInfo.meta_set("title", Name.c_str());
 
         // General info tags
         fileInfo.info_set("encoding", "Synthesized");
+        fileInfo.info_set_int("samplerate", _Generator->_SampleRate);
+        fileInfo.info_set_int("channels", _Generator->_ChannelCount);
 
-        fileInfo.info_set_int("fis_control_rate", _CSound._ControlRate);
-        fileInfo.info_set_int("fis_channel_count", _CSound._ChannelCount);
-        fileInfo.info_set_int("fis_0dbfs_level", (int64_t) _CSound._0dBFSLevel);
+        _Generator->GetInfo(fileInfo);
 /*
         // Meta data tags
         fileInfo.meta_add("title", _Decoder->GetTitle());
@@ -149,6 +187,9 @@ public:
 
     t_filestats2 get_stats2(uint32_t stats, abort_callback & abortHandler)
     {
+        if (_File.is_empty())
+            return filestats2_invalid;
+
         return _File->get_stats2_(stats, abortHandler);
     }
 
@@ -186,13 +227,44 @@ public:
     /// <summary>
     /// Initializes the decoder before playing the specified subsong. Resets playback position to the beginning of specified subsong.
     /// </summary>
-    void decode_initialize(unsigned, unsigned, abort_callback & abortHandler)
+    void decode_initialize(unsigned subSongIndex, unsigned, abort_callback & abortHandler)
     {
         abortHandler.check();
 
-        _File->reopen(abortHandler); // Equivalent to seek to zero, except it also works on nonseekable streams
+        if (_File.is_valid())
+            _File->reopen(abortHandler); // Equivalent to seek to zero, except it also works on nonseekable streams
+
+        _Generator->SelectSubsong(subSongIndex);
+        _Generator->Start();
 
-        _CSound.Start();
+        if (CfgOutputHash.get())
+            _OutputHash.Start(_FilePath, subSongIndex, _Generator->_SampleRate, _Generator->_ChannelCount, abortHandler);
+
+        if (CfgSpectrumVerification.get())
+        {
+            pfc::string8 SpecPath = _FilePath;
+
+            SpecPath += ".spectrum";
+
+            if (filesystem::g_exists(SpecPath, abortHandler))
+            {
+                service_ptr_t<file> File;
+
+                filesystem::g_open_read(File, SpecPath, abortHandler);
+
+                std::string Text;
+
+                Text.resize((size_t) File->get_size_ex(abortHandler));
+
+                File->read_object(Text.data(), Text.size(), abortHandler);
+
+                signal_document_t Spec;
+
+                Spec.Parse(Text.c_str(), Text.size());
+
+                _SpectrumVerifier.Start(Spec, _Generator->_SampleRate, _Generator->_ChannelCount);
+            }
+        }
     }
 
     /// <summary>
@@ -202,7 +274,25 @@ public:
     {
         abortHandler.check();
 
-        return _CSound.Render(audioChunk);
+        const bool Result = _Generator->Render(audioChunk);
+
+        if (_OutputHash.IsActive())
+        {
+            if (Result)
+                _OutputHash.Update(audioChunk.get_data(), audioChunk.get_sample_count());
+            else
+                _OutputHash.Finish(abortHandler);
+        }
+
+        if (_SpectrumVerifier.IsActive())
+        {
+            if (Result)
+                _SpectrumVerifier.Update(audioChunk.get_data(), audioChunk.get_sample_count());
+            else
+                _SpectrumVerifier.Finish();
+        }
+
+        return Result;
     }
 
     /// <summary>
@@ -211,6 +301,20 @@ public:
     void decode_seek(double timeInSeconds, abort_callback & abortHandler)
     {
         abortHandler.check();
+
+        if (_OutputHash.IsActive())
+        {
+            Log.AtInfo().Write(STR_COMPONENT_NAME " stops hashing the output because the playback position was changed.");
+            _OutputHash.Cancel();
+        }
+
+        if (_SpectrumVerifier.IsActive())
+        {
+            Log.AtInfo().Write(STR_COMPONENT_NAME " stops verifying the spectrum because the playback position was changed.");
+            _SpectrumVerifier.Cancel();
+        }
+
+        _Generator->Seek((uint64_t) (timeInSeconds * _Generator->_SampleRate + .5));
     }
 
     /// <summary>
@@ -230,7 +334,7 @@ public:
 
         if (!_IsDynamicInfoSet)
         {
-            fileInfo.info_set_int("sample_rate", _CSound._SampleRate);
+            fileInfo.info_set_int("sample_rate", _Generator->_SampleRate);
 
 //          fileInfo.info_set_bitrate(((t_int64) _Decoder->GetBitsPerSample() * _Decoder->GetChannelCount() * _SynthesisRate + 500 /* rounding for bps to kbps*/) / 1000 /* bps to kbps */);
 
@@ -239,6 +343,9 @@ public:
             IsDynamicInfoUpdated = true;
         }
 
+        if (_Generator->GetDynamicInfo(fileInfo))
+            IsDynamicInfoUpdated = true;
+
         return IsDynamicInfoUpdated;
     }
 
@@ -252,28 +359,431 @@ public:
 
     void decode_on_idle(abort_callback & abortHandler)
     {
-        _File->on_idle(abortHandler);
+        if (_File.is_valid())
+            _File->on_idle(abortHandler);
     }
 
     #pragma endregion
 
+private:
+    /// <summary>
+    /// Loads a Csound document. A local file is memory-mapped and compiled without copying it, unless the mapping does not end with a zero.
+    /// Other files are read into a string. Compressed files are decompressed into a string.
+    /// </summary>
+    void LoadCSD(const char * filePath, t_input_open_reason reason, abort_callback & abortHandler)
+    {
+        pfc::string8 NativePath;
+        auto Stream = std::make_unique<msc::memory_stream_t>();
+
+        bool IsMapped = false;
+
+        if (!IsCompressedDocument(filePath) && foobar2000_io::extract_native_path(filePath, NativePath))
+        {
+            try
+            {
+                IsMapped = Stream->Open(msc::UTF8ToWide(NativePath.c_str(), NativePath.get_length()), 0, 0) && Stream->IsZeroTerminated();
+            }
+            catch (const std::exception & e)
+            {
+                Log.AtDebug().Write(STR_COMPONENT_NAME " failed to map \"%s\": %s", NativePath.c_str(), e.what());
+            }
+        }
+
+        std::string Text;
+
+        if (IsCompressedDocument(filePath))
+            Decompress(Text, abortHandler);
+        else
+        if (!IsMapped)
+        {
+            Text.resize((size_t) _FileStats.m_size);
+
+            _File->read_object(Text.data(), Text.size(), abortHandler);
+        }
+
+        const char * Script = IsMapped ? (const char *) Stream->Data() : Text.c_str();
+
+        // Read the properties from the orchestra header if only the information of the file is needed. Creating a Csound instance loads all the opcode plugins.
+        // Documents that include other files are left to Csound because the included files can contain score sections or subsong instruments.
+        if ((reason == input_open_info_read) && (::strstr(Script, "#include") == nullptr))
+        {
+            auto Header = std::make_unique<csound_header_t>();
+
+            if (Header->Parse(Script))
+            {
+                Header->SetSubsongs(GetSubsongs(Script));
+
+                _Generator = std::move(Header);
+
+                return;
+            }
+        }
+
+        auto CSound = csound_t::Create();
+
+        // Resolve the included files and sound files through the foobar2000 file system.
+        {
+            auto Dependencies = std::make_unique<dependencies_t>(filePath, reason != input_open_info_read);
+
+            std::string RewrittenText;
+
+            if (Dependencies->Resolve(Script, RewrittenText, abortHandler))
+            {
+                Text = std::move(RewrittenText);
+                Script = Text.c_str();
+            }
+
+            CSound->SetDependencies(std::move(Dependencies));
+        }
+
+        // Play every score section or every instrument marked as subsong as a separate subsong. The orchestra is compiled once for all subsongs.
+        {
+            std::vector<subsong_t> Subsongs = GetSubsongs(Script);
+
+            if (!Subsongs.empty() && !Subsongs[0].Instrument.empty())
+            {
+                // Keep Csound running while an instrument is being played and comment out the i statements of the score. Only the selected instrument is played.
+                const char * ScoreHead = ::strstr(Script, "<CsScore>");
+                const char * ScoreTail = (ScoreHead != nullptr) ? ::strstr(ScoreHead, "</CsScore>") : nullptr;
+
+                if (ScoreTail != nullptr)
+                {
+                    std::string RewrittenText(Script, ScoreHead + 9);
+
+                    RewrittenText += "\nf 0 z\n";
+
+                    for (const char * Line = ScoreHead + 9; Line < ScoreTail;)
+                    {
+                        const char * LineTail = Line;
+
+                        while ((LineTail < ScoreTail) && (*LineTail != '\n'))
+                            ++LineTail;
+
+                        const char * p = Line;
+
+                        while ((p < LineTail) && std::isspace((unsigned char) *p))
+                            ++p;
+
+                        if ((p < LineTail) && (*p == 'i'))
+                            RewrittenText += ';';
+
+                        RewrittenText.append(Line, (LineTail < ScoreTail) ? LineTail + 1 : ScoreTail);
+
+                        Line = (LineTail < ScoreTail) ? LineTail + 1 : ScoreTail;
+                    }
+
+                    RewrittenText += ScoreTail;
+
+                    Text = std::move(RewrittenText);
+                    Script = Text.c_str();
+                }
+                else
+                    Subsongs.clear();
+            }
+
+            if (!Subsongs.empty())
+            {
+                Log.AtInfo().Write(STR_COMPONENT_NAME " found %zu subsongs.", Subsongs.size());
+
+                CSound->SetSubsongs(std::move(Subsongs));
+            }
+        }
+
+        // Stream the instrument statements of a large score while rendering. The score stream takes ownership of the original text.
+        {
+            auto Score = std::make_unique<score_stream_t>();
+
+            std::string CompiledText;
+
+            if (Score->Prepare(Script, CompiledText))
+            {
+                if (Script == Text.c_str())
+                    Score->SetText(std::move(Text));
+                else
+                    Score->SetText(std::move(Stream));
+
+                Text = std::move(CompiledText);
+                Script = Text.c_str();
+
+                CSound->SetScore(std::move(Score));
+            }
+        }
+
+        CSound->Load(Script);
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " is using Csound %s.", CSound->GetVersion().c_str());
+
+        _Generator = std::move(CSound);
+    }
+
+    /// <summary>
+    /// Loads a MIDI file and the Csound orchestra that renders it. Both are specified by a signal document.
+    /// </summary>
+    void LoadMIDI(const char * filePath, const signal_document_t & document, t_input_open_reason reason, abort_callback & abortHandler)
+    {
+        if (!document.Has("midi") || !document.Has("orchestra"))
+            throw exception_io_data("MIDI playback requires a midi and an orchestra file");
+
+        const std::string Directory = pfc::string_directory(filePath).c_str();
+
+        const std::string MIDIFilePath = dependencies_t::Combine(Directory, document.GetString("midi"));
+        const std::string OrchestraFilePath = dependencies_t::Combine(Directory, document.GetString("orchestra"));
+
+        auto MIDIFile = std::make_unique<midi_file_t>();
+
+        {
+            service_ptr_t<file> File;
+
+            filesystem::g_open_read(File, MIDIFilePath.c_str(), abortHandler);
+
+            std::vector<uint8_t> Data((size_t) File->get_size_ex(abortHandler));
+
+            File->read_object(Data.data(), Data.size(), abortHandler);
+
+            MIDIFile->Parse(Data.data(), Data.size());
+        }
+
+        std::string Text;
+
+        {
+            service_ptr_t<file> File;
+
+            filesystem::g_open_read(File, OrchestraFilePath.c_str(), abortHandler);
+
+            Text.resize((size_t) File->get_size_ex(abortHandler));
+
+            File->read_object(Text.data(), Text.size(), abortHandler);
+        }
+
+        auto CSound = csound_t::Create();
+
+        // Resolve the included files and sound files relative to the orchestra.
+        {
+            auto Dependencies = std::make_unique<dependencies_t>(OrchestraFilePath.c_str(), reason != input_open_info_read);
+
+            std::string RewrittenText;
+
+            if (Dependencies->Resolve(Text.c_str(), RewrittenText, abortHandler))
+                Text = std::move(RewrittenText);
+
+            CSound->SetDependencies(std::move(Dependencies));
+        }
+
+        // Keep Csound running until the MIDI file and the release of the last notes have been played.
+        const double Duration = MIDIFile->Duration() + document.GetDouble("tail", 2., 0., 60.);
+
+        const std::string Statement = msc::FormatText("\nf 0 %.6f\n", Duration);
+
+        const size_t ScoreHead = Text.find("<CsScore>");
+
+        if (ScoreHead != std::string::npos)
+            Text.insert(ScoreHead + 9, Statement);
+        else
+        {
+            const size_t Tail = Text.find("</CsoundSynthesizer>");
+
+            if (Tail == std::string::npos)
+                throw exception_io_data("Invalid Csound orchestra");
+
+            Text.insert(Tail, "<CsScore>" + Statement + "</CsScore>\n");
+        }
+
+        CSound->SetMIDIFile(std::move(MIDIFile), Duration);
+        CSound->Load(Text.c_str());
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " is using Csound %s.", CSound->GetVersion().c_str());
+
+        _Generator = std::move(CSound);
+    }
+
+    /// <summary>
+    /// Decompresses a compressed Csound document into the specified string. The decompressed text is read in blocks through the unpacker, directly into its final location.
+    /// The size stored in a gzip trailer is used to reserve the memory up front so the text is not moved while it grows.
+    /// </summary>
+    void Decompress(std::string & text, abort_callback & abortHandler) const
+    {
+        // The last 4 bytes of a gzip file contain the decompressed size modulo 4 GB.
+        t_filesize SizeHint = filesize_invalid;
+
+        if ((::stricmp_utf8(pfc::string_extension(_FilePath), "gz") == 0) && _File->can_seek() && (_FileStats.m_size > 18))
+        {
+            uint32_t Trailer = 0;
+
+            _File->seek(_FileStats.m_size - sizeof(Trailer), abortHandler);
+            _File->read_object(&Trailer, sizeof(Trailer), abortHandler);
+            _File->seek(0, abortHandler);
+
+            if (Trailer >= _FileStats.m_size)
+                SizeHint = Trailer;
+        }
+
+        service_ptr_t<file> Unpacked;
+
+        try
+        {
+            unpacker::g_open(Unpacked, _File, abortHandler);
+        }
+        catch (const exception_io_data &)
+        {
+            throw exception_io_unsupported_format("No unpacker available for this compressed Csound document");
+        }
+
+        const size_t BlockSize = 4 * 1024 * 1024;
+
+        // Reserve the decompressed size so the text is not moved while it grows. Fall back to a typical compression ratio if the size is unknown.
+        t_filesize Size = Unpacked->get_size(abortHandler);
+
+        if (Size == filesize_invalid)
+            Size = (SizeHint != filesize_invalid) ? SizeHint : _FileStats.m_size * 8;
+
+        text.reserve((size_t) Size + BlockSize); // The last read needs room for a whole block.
+
+        for (;;)
+        {
+            const size_t Offset = text.size();
+
+            text.resize(Offset + BlockSize);
+
+            const size_t Read = Unpacked->read(text.data() + Offset, BlockSize, abortHandler);
+
+            text.resize(Offset + Read);
+
+            if (Read < BlockSize)
+                break;
+        }
+
+        Log.AtDebug().Write(STR_COMPONENT_NAME " decompressed %zu bytes.", text.size());
+    }
+
+    /// <summary>
+    /// Returns true if the file is a compressed Csound document (.csd.gz or .csd.zst).
+    /// </summary>
+    static bool IsCompressedDocument(const char * filePath) noexcept
+    {
+        const pfc::string_extension Extension(filePath);
+
+        if ((::stricmp_utf8(Extension, "gz") != 0) && (::stricmp_utf8(Extension, "zst") != 0))
+            return false;
+
+        const size_t Length = ::strlen(filePath) - ::strlen(Extension) - 1;
+
+        return (Length > 4) && (::_strnicmp(filePath + Length - 4, ".csd", 4) == 0);
+    }
+
+    /// <summary>
+    /// Returns true if the file is a native signal document.
+    /// </summary>
+    static bool IsSignalDocument(const char * filePath) noexcept
+    {
+        return ::stricmp_utf8(pfc::string_extension(filePath), "sig") == 0;
+    }
+
+    /// <summary>
+    /// Returns true if the file contains a single expression.
+    /// </summary>
+    static bool IsExpressionDocument(const char * filePath) noexcept
+    {
+        return ::stricmp_utf8(pfc::string_extension(filePath), "expr") == 0;
+    }
+
+    /// <summary>
+    /// Returns true if the path is an expression URL, e.g. "expr://0.5*sin(2*pi*440*t)?duration=10&channels=1".
+    /// </summary>
+    static bool IsExpressionURL(const char * filePath) noexcept
+    {
+        return pfc::strcmp_partial(filePath, ExpressionScheme) == 0;
+    }
+
+    /// <summary>
+    /// Converts an expression URL to a signal document. The query parameters are the keys of a signal document. Reserved characters can be percent-encoded.
+    /// </summary>
+    static void ParseExpressionURL(const char * url, signal_document_t & document)
+    {
+        // Split the URL before decoding it so that encoded separators can't split the expression or a value.
+        const std::string Text = url + ::strlen(ExpressionScheme);
+
+        const size_t Separator = Text.find('?');
+
+        document.Set("generator", "expression");
+        document.Set("expression", DecodeURL(Text.substr(0, Separator).c_str()));
+
+        if (Separator == std::string::npos)
+            return;
+
+        const std::string Query = Text.substr(Separator + 1);
+
+        for (size_t Head = 0; Head < Query.size();)
+        {
+            size_t Tail = Query.find('&', Head);
+
+            if (Tail == std::string::npos)
+                Tail = Query.size();
+
+            const std::string Parameter = Query.substr(Head, Tail - Head);
+
+            const size_t EqualSign = Parameter.find('=');
+
+            if (EqualSign == std::string::npos)
+                throw exception_io_data(msc::FormatText("Invalid parameter \"%s\" in expression URL", DecodeURL(Parameter.c_str()).c_str()).c_str());
+
+            std::string Key = DecodeURL(Parameter.substr(0, EqualSign).c_str());
+
+            std::transform(Key.begin(), Key.end(), Key.begin(), [](char c) { return (char) std::tolower((unsigned char) c); });
+
+            // The URL always describes an expression.
+            if ((Key != "expression") && (Key != "generator"))
+                document.Set(Key.c_str(), DecodeURL(Parameter.substr(EqualSign + 1).c_str()));
+
+            Head = Tail + 1;
+        }
+    }
+
+    /// <summary>
+    /// Decodes the percent-encoded characters of a URL.
+    /// </summary>
+    static std::string DecodeURL(const char * text)
+    {
+        std::string Result;
+
+        while (*text != '\0')
+        {
+            if ((text[0] == '%') && std::isxdigit((unsigned char) text[1]) && std::isxdigit((unsigned char) text[2]))
+            {
+                const char Digits[3] = { text[1], text[2], '\0' };
+
+                Result += (char) ::strtoul(Digits, nullptr, 16);
+                text += 3;
+            }
+            else
+                Result += *text++;
+        }
+
+        return Result;
+    }
+
 private:
     service_ptr_t<file> _File;
     pfc::string8 _FilePath;
     t_filestats _FileStats;
 
-    csound_t _CSound;
-    std::string _Script;
+    std::unique_ptr<generator_t> _Generator;
     uint32_t _SynthesisRate;
 
     // Dynamic track info
     uint32_t _LoopNumber;
 
     bool _IsDynamicInfoSet;
+
+    output_hash_t _OutputHash;
+    spectrum_verifier_t _SpectrumVerifier;
+
+    static constexpr const char * ExpressionScheme = "expr://";
 };
 #pragma warning(default: 4820) // x bytes padding added after last data member
 
 // Declare the supported file types to make it show in "open file" dialog etc.
-DECLARE_FILE_TYPE("Csound Documents (CSD)", "*.csd");
+DECLARE_FILE_TYPE("Csound Documents (CSD)", "*.csd;*.csd.gz;*.csd.zst");
+DECLARE_FILE_TYPE("Signal Documents (SIG)", "*.sig");
+DECLARE_FILE_TYPE("Signal Expressions (EXPR)", "*.expr");
 
 static input_factory_t<InputDecoder> _InputDecoderFactory;
@@ -0,0 +1,214 @@
+
+/** $VER: MIDIFile.cpp (2026.10.19) P. Stuer - Standard MIDI File reader **/
+
+#include "pch.h"
+
+#include "MIDIFile.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+static uint32_t ReadVariableLength(const uint8_t *& p, const uint8_t * tail);
+
+static inline uint32_t Read32(const uint8_t * p) noexcept { return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3]; }
+static inline uint16_t Read16(const uint8_t * p) noexcept { return (uint16_t) ((p[0] << 8) | p[1]); }
+
+/// <summary>
+/// Parses the specified data in a single pass.
+/// </summary>
+void midi_file_t::Parse(const uint8_t * data, size_t size)
+{
+    const uint8_t * Tail = data + size;
+
+    if ((size < 14) || (::memcmp(data, "MThd", 4) != 0))
+        throw exception_io_data("Not a Standard MIDI File");
+
+    const uint32_t HeaderSize = Read32(data + 4);
+    const uint16_t Format     = Read16(data + 8);
+    const uint16_t Division   = Read16(data + 12);
+
+    if ((HeaderSize < 6) || (Format > 1) || (Division == 0) || (8 + (size_t) HeaderSize > size))
+        throw exception_io_data(msc::FormatText("Unsupported MIDI file (format %d)", Format).c_str());
+
+    std::vector<track_event_t> Events;
+    std::vector<tempo_t> Tempos;
+    uint64_t LastTick = 0;
+
+    // Parse all tracks. The events of each track are appended to the same array and merged afterwards.
+    for (const uint8_t * p = data + 8 + HeaderSize; p + 8 <= Tail;)
+    {
+        const uint32_t ChunkSize = Read32(p + 4);
+        const uint8_t * ChunkHead = p + 8;
+        const uint8_t * ChunkTail = ((size_t) (Tail - ChunkHead) < ChunkSize) ? Tail : ChunkHead + ChunkSize; // Tolerate a truncated last track.
+
+        if (::memcmp(p, "MTrk", 4) == 0)
+            ParseTrack(ChunkHead, ChunkTail, Events, Tempos, LastTick);
+
+        p = ChunkTail;
+    }
+
+    std::stable_sort(Events.begin(), Events.end(), [](const track_event_t & a, const track_event_t & b) { return a.Tick < b.Tick; });
+    std::stable_sort(Tempos.begin(), Tempos.end(), [](const tempo_t & a, const tempo_t & b) { return a.Tick < b.Tick; });
+
+    // Convert the ticks to seconds.
+    double SecondsPerTick;
+
+    if (Division & 0x8000)
+    {
+        // SMPTE time: frames per second and ticks per frame.
+        const int FramesPerSecond = -(int8_t) (Division >> 8);
+        const int TicksPerFrame = Division & 0xFF;
+
+        SecondsPerTick = 1. / ((FramesPerSecond == 29 ? 29.97 : (double) FramesPerSecond) * (double) TicksPerFrame);
+
+        Tempos.clear(); // Tempo changes don't apply.
+    }
+    else
+        SecondsPerTick = 0.5 / (double) Division; // 120 BPM until the first tempo change.
+
+    _Events.clear();
+    _Events.reserve(Events.size());
+
+    auto Tempo = Tempos.begin();
+
+    uint64_t TempoTick = 0;
+    double TempoTime = 0.;
+
+    auto ToTime = [&](uint64_t tick) -> double
+    {
+        while ((Tempo != Tempos.end()) && (Tempo->Tick <= tick))
+        {
+            TempoTime += (double) (Tempo->Tick - TempoTick) * SecondsPerTick;
+            TempoTick = Tempo->Tick;
+
+            SecondsPerTick = (double) Tempo->MicrosecondsPerQuarterNote / 1'000'000. / (double) Division;
+
+            ++Tempo;
+        }
+
+        return TempoTime + (double) (tick - TempoTick) * SecondsPerTick;
+    };
+
+    for (const auto & Event : Events)
+        _Events.push_back({ ToTime(Event.Tick), Event.Size, { Event.Data[0], Event.Data[1], Event.Data[2] } });
+
+    _Duration = ToTime(LastTick);
+
+    Log.AtInfo().Write(STR_COMPONENT_NAME " read %zu MIDI events (%.3f s).", _Events.size(), _Duration);
+}
+
+/// <summary>
+/// Gets the index of the first event at or after the specified time.
+/// </summary>
+size_t midi_file_t::Find(double time) const noexcept
+{
+    const auto Item = std::lower_bound(_Events.begin(), _Events.end(), time, [](const midi_event_t & event, double t) { return event.Time < t; });
+
+    return (size_t) (Item - _Events.begin());
+}
+
+/// <summary>
+/// Parses the events of a track. Only the channel messages and the tempo changes are kept.
+/// </summary>
+void midi_file_t::ParseTrack(const uint8_t * p, const uint8_t * tail, std::vector<track_event_t> & events, std::vector<tempo_t> & tempos, uint64_t & lastTick)
+{
+    static const uint8_t DataSizes[8] = { 2, 2, 2, 2, 1, 1, 2, 0 }; // Number of data bytes of the messages 0x80 to 0xF0.
+
+    uint64_t Tick = 0;
+    uint8_t RunningStatus = 0;
+
+    while (p < tail)
+    {
+        Tick += ReadVariableLength(p, tail);
+
+        if (p >= tail)
+            break;
+
+        uint8_t Status = *p;
+
+        if (Status & 0x80)
+            ++p;
+        else
+        if (RunningStatus != 0)
+            Status = RunningStatus;
+        else
+            throw exception_io_data("Invalid MIDI track data");
+
+        if (Status < 0xF0)
+        {
+            const uint8_t Size = DataSizes[(Status >> 4) - 8];
+
+            if (p + Size > tail)
+                throw exception_io_data("Truncated MIDI track");
+
+            events.push_back({ Tick, (uint8_t) (1 + Size), { Status, p[0], (Size > 1) ? p[1] : (uint8_t) 0 } });
+
+            RunningStatus = Status;
+            p += Size;
+        }
+        else
+        if (Status == 0xFF)
+        {
+            if (p >= tail)
+                break;
+
+            const uint8_t Type = *p++;
+            const uint32_t Size = ReadVariableLength(p, tail);
+
+            if ((size_t) (tail - p) < Size)
+                throw exception_io_data("Truncated MIDI meta event");
+
+            if ((Type == 0x51) && (Size == 3))
+                tempos.push_back({ Tick, ((uint32_t) p[0] << 16) | ((uint32_t) p[1] << 8) | p[2] });
+
+            p += Size;
+
+            RunningStatus = 0;
+
+            if (Type == 0x2F)
+                break; // End of Track
+        }
+        else
+        if ((Status == 0xF0) || (Status == 0xF7))
+        {
+            // System Exclusive messages are not passed to Csound.
+            const uint32_t Size = ReadVariableLength(p, tail);
+
+            if ((size_t) (tail - p) < Size)
+                throw exception_io_data("Truncated MIDI SysEx message");
+
+            p += Size;
+
+            RunningStatus = 0;
+        }
+        else
+            throw exception_io_data("Invalid MIDI status byte");
+    }
+
+    lastTick = std::max(lastTick, Tick);
+}
+
+/// <summary>
+/// Reads a variable-length quantity.
+/// </summary>
+static uint32_t ReadVariableLength(const uint8_t *& p, const uint8_t * tail)
+{
+    uint32_t Value = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        if (p >= tail)
+            throw exception_io_data("Truncated MIDI data");
+
+        const uint8_t Byte = *p++;
+
+        Value = (Value << 7) | (Byte & 0x7F);
+
+        if ((Byte & 0x80) == 0)
+            return Value;
+    }
+
+    throw exception_io_data("Invalid variable-length quantity");
+}
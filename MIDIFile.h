@@ -0,0 +1,52 @@
+
+/** $VER: MIDIFile.h (2026.10.19) P. Stuer - Standard MIDI File reader **/
+
+#pragma once
+
+#include <vector>
+
+/// <summary>
+/// Represents a channel message of a MIDI file.
+/// </summary>
+struct midi_event_t
+{
+    double Time;        // Time in seconds
+    uint8_t Size;       // Number of bytes in the message
+    uint8_t Data[3];
+};
+
+/// <summary>
+/// Reads the channel messages of a Standard MIDI File (format 0 and 1). The messages of all tracks are merged and converted to time in seconds using the tempo map of the file.
+/// </summary>
+class midi_file_t
+{
+public:
+    midi_file_t() noexcept : _Duration() { }
+
+    void Parse(const uint8_t * data, size_t size);
+
+    size_t Find(double time) const noexcept;
+
+    const std::vector<midi_event_t> & Events() const noexcept { return _Events; }
+    double Duration() const noexcept { return _Duration; }
+
+private:
+    struct tempo_t
+    {
+        uint64_t Tick;
+        uint32_t MicrosecondsPerQuarterNote;
+    };
+
+    struct track_event_t
+    {
+        uint64_t Tick;
+        uint8_t Size;
+        uint8_t Data[3];
+    };
+
+    static void ParseTrack(const uint8_t * data, const uint8_t * tail, std::vector<track_event_t> & events, std::vector<tempo_t> & tempos, uint64_t & lastTick);
+
+private:
+    std::vector<midi_event_t> _Events;  // Sorted by time
+    double _Duration;                   // Time of the last message, including meta messages like End of Track.
+};
@@ -0,0 +1,338 @@
+
+/** $VER: Multitone.cpp (2026.10.19) P. Stuer - Multitone and intermodulation test signals **/
+
+#include "pch.h"
+
+#include "Multitone.h"
+#include "SignalDocument.h"
+#include "Wavetable.h"
+#include "FFT.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#include <numbers>
+#include <random>
+
+#pragma hdrstop
+
+static_assert(sizeof(audio_sample) == sizeof(double), "sizeof(audio_sample) != sizeof(double)");
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+multitone_t::multitone_t(const signal_document_t & document) : native_generator_t(document), _Position(), _CrestFactor()
+{
+    const size_t PeriodSize = (size_t) document.GetInteger("period", 65536, 4096, 1048576);
+
+    if (!std::has_single_bit(PeriodSize))
+        throw exception_io_data("Period must be a power of 2");
+
+    _Period.resize(PeriodSize);
+
+    const std::string Name = document.GetString("generator");
+
+    std::vector<tone_t> Tones = GetTones(document, Name);
+
+    _ToneCount = Tones.size();
+
+    const std::string Phases = document.GetString("phases", "schroeder");
+
+    SetPhases(Tones, Phases, (uint32_t) document.GetInteger("seed", 1, 0, UINT32_MAX));
+
+    const bool IsOptimized = msc::IsOneOf(Phases.c_str(), { "optimized" });
+
+    if ((Tones.size() > MaxWavetableTones) || IsOptimized)
+        SynthesizeFromSpectrum(Tones, IsOptimized ? (int) document.GetInteger("iterations", 50, 1, 1000) : 0);
+    else
+        SynthesizeFromWavetable(Tones);
+
+    Normalize();
+
+    Log.AtInfo().Write(STR_COMPONENT_NAME " generates %zu tones with a crest factor of %.2f dB.", _ToneCount, 20. * std::log10(_CrestFactor));
+}
+
+/// <summary>
+/// Returns true if the specified name identifies one of the signals of this generator.
+/// </summary>
+bool multitone_t::IsOurGenerator(const std::string & name) noexcept
+{
+    return msc::IsOneOf(name.c_str(), { "multitone", "imd-smpte", "imd-ccif", "imd-din" });
+}
+
+/// <summary>
+/// Adds generator specific info tags.
+/// </summary>
+void multitone_t::GetInfo(file_info & fileInfo) const noexcept
+{
+    fileInfo.info_set_int("fis_tone_count", (int64_t) _ToneCount);
+    fileInfo.info_set_int("fis_period", (int64_t) _Period.size());
+    fileInfo.info_set_float("fis_crest_factor", 20. * std::log10(_CrestFactor), 2, false, "dB");
+}
+
+/// <summary>
+/// Generates the specified number of interleaved frames at the current position.
+/// </summary>
+void multitone_t::Generate(audio_sample * data, size_t frameCount) noexcept
+{
+    const size_t PeriodSize = _Period.size();
+
+    while (frameCount != 0)
+    {
+        const size_t n = std::min(frameCount, PeriodSize - _Position);
+        const audio_sample * Src = _Period.data() + _Position;
+
+        if (_ChannelCount == 1)
+        {
+            ::memcpy(data, Src, n * sizeof(*data));
+            data += n;
+        }
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                for (uint32_t j = 0; j < _ChannelCount; ++j)
+                    *data++ = Src[i];
+        }
+
+        _Position = (_Position + n) & (PeriodSize - 1);
+        frameCount -= n;
+    }
+}
+
+/// <summary>
+/// Gets the tones of the signal.
+/// </summary>
+std::vector<multitone_t::tone_t> multitone_t::GetTones(const signal_document_t & document, const std::string & name) const
+{
+    const double BinsPerHz = (double) _Period.size() / _SampleRate;
+    const size_t MaxBin = (_Period.size() / 2) - 1;
+
+    auto ToBin = [BinsPerHz, MaxBin](double frequency) -> size_t
+    {
+        return std::clamp((size_t) std::llround(frequency * BinsPerHz), (size_t) 1, MaxBin);
+    };
+
+    std::vector<tone_t> Tones;
+
+    if (msc::IsOneOf(name.c_str(), { "imd-smpte", "imd-ccif", "imd-din" }))
+    {
+        // SMPTE RP120: 60 Hz and 7 kHz, 4:1. DIN 45403: 250 Hz and 8 kHz, 4:1. CCIF: 19 kHz and 20 kHz, 1:1.
+        double F1 = 60., F2 = 7000., Ratio = 4.;
+
+        if (msc::IsOneOf(name.c_str(), { "imd-din" }))
+        {
+            F1 = 250.; F2 = 8000.;
+        }
+        else
+        if (msc::IsOneOf(name.c_str(), { "imd-ccif" }))
+        {
+            F1 = 19000.; F2 = 20000.; Ratio = 1.;
+        }
+
+        F1    = document.GetDouble("f1", F1, 1., _SampleRate / 2.);
+        F2    = document.GetDouble("f2", F2, 1., _SampleRate / 2.);
+        Ratio = document.GetDouble("ratio", Ratio, 0.001, 1000.);
+
+        Tones.push_back({ ToBin(F1), Ratio, 0. });
+        Tones.push_back({ ToBin(F2), 1., 0. });
+
+        if (Tones[0].Bin == Tones[1].Bin)
+            throw exception_io_data("Frequencies of the two tones are too close together");
+    }
+    else
+    {
+        std::vector<double> Frequencies = document.GetDoubles("frequencies");
+
+        if (Frequencies.empty())
+        {
+            const size_t ToneCount = (size_t) document.GetInteger("tones", 31, 1, (int64_t) MaxBin);
+            const double Low  = document.GetDouble("low", 20., 1., _SampleRate / 2.);
+            const double High = document.GetDouble("high", std::min(20000., _SampleRate / 2.), Low, _SampleRate / 2.);
+
+            const bool IsLinear = msc::IsOneOf(document.GetString("spacing", "log").c_str(), { "linear" });
+
+            for (size_t i = 0; i < ToneCount; ++i)
+            {
+                const double t = (ToneCount > 1) ? (double) i / (double) (ToneCount - 1) : 0.;
+
+                Frequencies.push_back(IsLinear ? Low + (High - Low) * t : Low * std::pow(High / Low, t));
+            }
+        }
+
+        std::vector<double> Amplitudes = document.GetDoubles("amplitudes");
+
+        if (!Amplitudes.empty() && (Amplitudes.size() != Frequencies.size()))
+            throw exception_io_data("Number of amplitudes does not match the number of frequencies");
+
+        for (size_t i = 0; i < Frequencies.size(); ++i)
+        {
+            size_t Bin = ToBin(Frequencies[i]);
+
+            // Tones that round to the same bin are moved up so every tone keeps its own bin.
+            if (!Tones.empty() && (Bin <= Tones.back().Bin))
+                Bin = Tones.back().Bin + 1;
+
+            if (Bin > MaxBin)
+                throw exception_io_data("Too many tones for the period length");
+
+            Tones.push_back({ Bin, Amplitudes.empty() ? 1. : Amplitudes[i], 0. });
+        }
+    }
+
+    for (const auto & Tone : Tones)
+        Log.AtDebug().Write(STR_COMPONENT_NAME " tone at %.6f Hz", (double) Tone.Bin / BinsPerHz);
+
+    return Tones;
+}
+
+/// <summary>
+/// Sets the phases of the tones using the specified method.
+/// </summary>
+void multitone_t::SetPhases(std::vector<tone_t> & tones, const std::string & method, uint32_t seed) const noexcept
+{
+    const double N = (double) tones.size();
+
+    if (msc::IsOneOf(method.c_str(), { "zero" }))
+    {
+        for (auto & Tone : tones)
+            Tone.Phase = 0.;
+    }
+    else
+    if (msc::IsOneOf(method.c_str(), { "newman" }))
+    {
+        for (size_t k = 0; k < tones.size(); ++k)
+            tones[k].Phase = std::numbers::pi * (double) (k * k) / N;
+    }
+    else
+    if (msc::IsOneOf(method.c_str(), { "random" }))
+    {
+        std::mt19937 Generator(seed);
+        std::uniform_real_distribution<double> Distribution(0., 2. * std::numbers::pi);
+
+        for (auto & Tone : tones)
+            Tone.Phase = Distribution(Generator);
+    }
+    else
+    {
+        // Schroeder phases. Also the starting point of the optimization.
+        for (size_t k = 0; k < tones.size(); ++k)
+            tones[k].Phase = -std::numbers::pi * (double) (k * (k + 1)) / N;
+    }
+}
+
+/// <summary>
+/// Synthesizes one period by adding the tones using the shared sine table.
+/// </summary>
+void multitone_t::SynthesizeFromWavetable(const std::vector<tone_t> & tones)
+{
+    // The table has the same size as the period so every tone advances a whole number of table entries per sample.
+    auto Table = wavetable_t::GetSine(_Period.size());
+
+    const double * Sine = Table->Data();
+    const size_t Mask = Table->Mask();
+
+    std::fill(_Period.begin(), _Period.end(), 0.);
+
+    for (const auto & Tone : tones)
+    {
+        const size_t Offset = (size_t) std::llround(Tone.Phase / (2. * std::numbers::pi) * (double) _Period.size()) & Mask;
+
+        for (size_t i = 0; i < _Period.size(); ++i)
+            _Period[i] += Tone.Amplitude * Sine[(i * Tone.Bin + Offset) & Mask];
+    }
+}
+
+/// <summary>
+/// Synthesizes one period with an inverse FFT of the spectrum. Optionally reduces the crest factor by iteratively clipping the signal and restoring the amplitude spectrum.
+/// </summary>
+void multitone_t::SynthesizeFromSpectrum(const std::vector<tone_t> & tones, int iterations)
+{
+    const size_t Size = _Period.size();
+
+    fft_t FFT(Size);
+
+    std::vector<std::complex<double>> Spectrum(Size);
+    std::vector<double> Phases(tones.size());
+
+    for (size_t i = 0; i < tones.size(); ++i)
+        Phases[i] = tones[i].Phase;
+
+    double BestCrestFactor = std::numeric_limits<double>::max();
+    std::vector<double> BestPhases = Phases;
+
+    for (int Iteration = 0; ; ++Iteration)
+    {
+        std::fill(Spectrum.begin(), Spectrum.end(), std::complex<double>());
+
+        for (size_t i = 0; i < tones.size(); ++i)
+        {
+            const auto X = std::polar(tones[i].Amplitude / 2., Phases[i]);
+
+            Spectrum[tones[i].Bin]        = X;
+            Spectrum[Size - tones[i].Bin] = std::conj(X);
+        }
+
+        FFT.Transform(Spectrum.data(), true);
+
+        if (Iteration >= iterations)
+            break;
+
+        double Peak = 0., Power = 0.;
+
+        for (const auto & x : Spectrum)
+        {
+            Peak = std::max(Peak, std::abs(x.real()));
+            Power += x.real() * x.real();
+        }
+
+        const double RMS = std::sqrt(Power / (double) Size);
+        const double CrestFactor = Peak / RMS;
+
+        if (CrestFactor < BestCrestFactor)
+        {
+            BestCrestFactor = CrestFactor;
+            BestPhases = Phases;
+        }
+
+        // Clip the peaks, go back to the frequency domain and keep only the new phases.
+        const double Limit = RMS * std::max(1.4, 0.8 * CrestFactor);
+
+        for (auto & x : Spectrum)
+            x = std::complex<double>(std::clamp(x.real(), -Limit, Limit), 0.);
+
+        FFT.Transform(Spectrum.data(), false);
+
+        for (size_t i = 0; i < tones.size(); ++i)
+            Phases[i] = std::arg(Spectrum[tones[i].Bin]);
+
+        if (Iteration + 1 == iterations)
+            Phases = BestPhases;
+    }
+
+    for (size_t i = 0; i < Size; ++i)
+        _Period[i] = Spectrum[i].real();
+}
+
+/// <summary>
+/// Scales the period to the requested peak level and calculates the crest factor.
+/// </summary>
+void multitone_t::Normalize() noexcept
+{
+    double Peak = 0., Power = 0.;
+
+    for (const auto x : _Period)
+    {
+        Peak = std::max(Peak, std::abs(x));
+        Power += x * x;
+    }
+
+    if (Peak == 0.)
+        return;
+
+    _CrestFactor = Peak / std::sqrt(Power / (double) _Period.size());
+
+    const double Scale = _Level / Peak;
+
+    for (auto & x : _Period)
+        x *= Scale;
+}
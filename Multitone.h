@@ -0,0 +1,55 @@
+
+/** $VER: Multitone.h (2026.10.19) P. Stuer - Multitone and intermodulation test signals **/
+
+#pragma once
+
+#include "Generator.h"
+
+#include <vector>
+
+/// <summary>
+/// Generates multitone and intermodulation (SMPTE, CCIF, DIN) test signals. One period of the signal is synthesized when the generator is created.
+/// All frequencies are rounded to a multiple of the sample rate divided by the period length so the signal repeats seamlessly.
+/// </summary>
+class multitone_t : public native_generator_t
+{
+public:
+    multitone_t(const signal_document_t & document);
+
+    static bool IsOurGenerator(const std::string & name) noexcept;
+
+    void GetInfo(file_info & fileInfo) const noexcept override;
+
+protected:
+    void Generate(audio_sample * data, size_t frameCount) noexcept override;
+
+    void SetPosition(uint64_t frameIndex) noexcept override
+    {
+        _Position = (size_t) (frameIndex & (_Period.size() - 1));
+    }
+
+private:
+    struct tone_t
+    {
+        size_t Bin;         // Frequency as a number of periods per signal period
+        double Amplitude;
+        double Phase;       // Radians
+    };
+
+    std::vector<tone_t> GetTones(const signal_document_t & document, const std::string & name) const;
+    void SetPhases(std::vector<tone_t> & tones, const std::string & method, uint32_t seed) const noexcept;
+
+    void SynthesizeFromWavetable(const std::vector<tone_t> & tones);
+    void SynthesizeFromSpectrum(const std::vector<tone_t> & tones, int iterations);
+
+    void Normalize() noexcept;
+
+private:
+    std::vector<audio_sample> _Period;
+    size_t _Position;
+
+    size_t _ToneCount;
+    double _CrestFactor;
+
+    static const size_t MaxWavetableTones = 16; // Use an inverse FFT to synthesize the period above this number of tones.
+};
@@ -0,0 +1,288 @@
+
+/** $VER: Oscillator.cpp (2026.10.19) P. Stuer - Sine oscillators with a 64-bit fixed-point phase **/
+
+#include "pch.h"
+
+#include "Oscillator.h"
+#include "SignalDocument.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#include <numbers>
+
+#pragma hdrstop
+
+static_assert(sizeof(audio_sample) == sizeof(double), "sizeof(audio_sample) != sizeof(double)");
+
+static const double TwoPow64 = 18446744073709551616.;
+
+/// <summary>
+/// Converts a fraction of a period to a 64-bit fixed-point phase.
+/// </summary>
+static uint64_t ToFixedPoint(double periods) noexcept
+{
+    const double Value = std::round(std::ldexp(periods - std::floor(periods), 64));
+
+    return (Value < TwoPow64) ? (uint64_t) Value : 0;
+}
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+oscillator_t::oscillator_t(const signal_document_t & document) : native_generator_t(document), _Block(BlockSize), _Position()
+{
+    std::vector<double> Frequencies = document.GetDoubles("frequencies");
+
+    if (Frequencies.empty())
+        Frequencies.push_back(document.GetDouble("frequency", 1000., 0., _SampleRate / 2.));
+
+    std::vector<double> Amplitudes = document.GetDoubles("amplitudes");
+
+    if (!Amplitudes.empty() && (Amplitudes.size() != Frequencies.size()))
+        throw exception_io_data("Number of amplitudes does not match the number of frequencies");
+
+    std::vector<double> Phases = document.GetDoubles("phases");
+
+    if (!Phases.empty() && (Phases.size() != Frequencies.size()))
+        throw exception_io_data("Number of phases does not match the number of frequencies");
+
+    double Sum = 0.;
+
+    for (size_t i = 0; i < Frequencies.size(); ++i)
+    {
+        const double Frequency = Frequencies[i];
+
+        if ((Frequency < 0.) || (Frequency > _SampleRate / 2.))
+            throw exception_io_data(msc::FormatText("Frequency %g Hz is outside the range 0 to %g Hz", Frequency, _SampleRate / 2.).c_str());
+
+        const double Amplitude = Amplitudes.empty() ? 1. : Amplitudes[i];
+        const double Phase = Phases.empty() ? 0. : Phases[i] / 360.; // Degrees to periods
+
+        tone_t Tone = { 0, 0, 1, ToFixedPoint(Phase), Amplitude };
+
+        SetIncrement(Tone, Frequency, _SampleRate);
+
+        _Tones.push_back(Tone);
+
+        Sum += std::abs(Amplitude);
+    }
+
+    // Scale the amplitudes so the peak of the sum can never exceed the requested level.
+    if (Sum > 0.)
+    {
+        for (auto & Tone : _Tones)
+            Tone.Amplitude *= _Level / Sum;
+    }
+
+    if (msc::IsOneOf(document.GetString("method", "polynomial").c_str(), { "table" }))
+        _Wavetable = wavetable_t::GetSine(WavetableSize);
+
+    for (const auto & Tone : _Tones)
+        Log.AtDebug().Write(STR_COMPONENT_NAME " oscillator at %.15f Hz", GetFrequency(Tone));
+}
+
+/// <summary>
+/// Returns true if the specified name identifies one of the signals of this generator.
+/// </summary>
+bool oscillator_t::IsOurGenerator(const std::string & name) noexcept
+{
+    return msc::IsOneOf(name.c_str(), { "sine" });
+}
+
+/// <summary>
+/// Adds generator specific info tags.
+/// </summary>
+void oscillator_t::GetInfo(file_info & fileInfo) const noexcept
+{
+    fileInfo.info_set_int("fis_tone_count", (int64_t) _Tones.size());
+
+    if (_Tones.size() == 1)
+        fileInfo.info_set_float("fis_frequency", GetFrequency(_Tones[0]), 9, false, "Hz");
+}
+
+/// <summary>
+/// Generates the specified number of interleaved frames at the current position.
+/// </summary>
+void oscillator_t::Generate(audio_sample * data, size_t frameCount) noexcept
+{
+    double * Block = _Block.data();
+
+    while (frameCount != 0)
+    {
+        const size_t n = std::min(frameCount, BlockSize);
+
+        std::fill(Block, Block + BlockSize, 0.);
+
+        for (const auto & Tone : _Tones)
+        {
+            if (_Wavetable)
+                RenderWavetable(Tone, Block, n);
+            else
+                RenderPolynomial(Tone, Block, n);
+        }
+
+        if (_ChannelCount == 1)
+            ::memcpy(data, Block, n * sizeof(*data));
+        else
+        {
+            for (size_t i = 0; i < n; ++i)
+                for (uint32_t j = 0; j < _ChannelCount; ++j)
+                    data[i * _ChannelCount + j] = Block[i];
+        }
+
+        data += n * _ChannelCount;
+
+        _Position += n;
+        frameCount -= n;
+    }
+}
+
+/// <summary>
+/// Adds a tone to the block using a polynomial approximation of the sine. The error is smaller than 1e-12.
+/// </summary>
+void oscillator_t::RenderPolynomial(const tone_t & tone, double * block, size_t frameCount) const noexcept
+{
+    uint64_t Phases[Lanes];
+    uint64_t Remainders[Lanes];
+
+    for (size_t k = 0; k < Lanes; ++k)
+        Phases[k] = GetPhase(tone, _Position + k, Remainders[k]);
+
+    const uint64_t Step = tone.Increment * Lanes + (tone.Remainder * Lanes) / tone.Denominator;
+    const uint64_t StepRemainder = (tone.Remainder * Lanes) % tone.Denominator;
+    const uint64_t Denominator = tone.Denominator;
+    const double Amplitude = tone.Amplitude;
+
+    for (size_t i = 0; i < frameCount; i += Lanes)
+    {
+        for (size_t k = 0; k < Lanes; ++k)
+        {
+            // Interpret the phase as a signed fraction of a period in [-0.5, 0.5) and fold it to [0, 0.25] using sin(pi - x) = sin(x).
+            const double x = (double) (int64_t) Phases[k] * (1. / TwoPow64);
+            const double a = std::abs(x);
+            const double r = 2. * std::numbers::pi * std::min(a, .5 - a);
+            const double r2 = r * r;
+
+            // Taylor series up to the 17th power.
+            double s = 1. / 355687428096000.;
+
+            s = s * r2 - 1. / 1307674368000.;
+            s = s * r2 + 1. / 6227020800.;
+            s = s * r2 - 1. / 39916800.;
+            s = s * r2 + 1. / 362880.;
+            s = s * r2 - 1. / 5040.;
+            s = s * r2 + 1. / 120.;
+            s = s * r2 - 1. / 6.;
+            s = s * r2 + 1.;
+
+            block[i + k] += Amplitude * std::copysign(s * r, x);
+
+            // Advance the phase. The fractional part carries into the phase without rounding.
+            Remainders[k] += StepRemainder;
+
+            const uint64_t Carry = (Remainders[k] >= Denominator) ? 1 : 0;
+
+            Remainders[k] -= Carry * Denominator;
+            Phases[k] += Step + Carry;
+        }
+    }
+}
+
+/// <summary>
+/// Adds a tone to the block using the shared sine table and linear interpolation. The error is smaller than 1.2e-9 (-178 dB).
+/// </summary>
+void oscillator_t::RenderWavetable(const tone_t & tone, double * block, size_t frameCount) const noexcept
+{
+    const double * Table = _Wavetable->Data();
+
+    const int IndexBits = std::countr_zero(WavetableSize);
+
+    uint64_t Phases[Lanes];
+    uint64_t Remainders[Lanes];
+
+    for (size_t k = 0; k < Lanes; ++k)
+        Phases[k] = GetPhase(tone, _Position + k, Remainders[k]);
+
+    const uint64_t Step = tone.Increment * Lanes + (tone.Remainder * Lanes) / tone.Denominator;
+    const uint64_t StepRemainder = (tone.Remainder * Lanes) % tone.Denominator;
+    const uint64_t Denominator = tone.Denominator;
+    const double Amplitude = tone.Amplitude;
+
+    for (size_t i = 0; i < frameCount; i += Lanes)
+    {
+        for (size_t k = 0; k < Lanes; ++k)
+        {
+            const size_t Index = (size_t) (Phases[k] >> (64 - IndexBits));
+            const double Fraction = (double) ((Phases[k] << IndexBits) >> 11) * (1. / 9007199254740992.);
+
+            // The table has a guard sample so Index + 1 never needs to wrap.
+            block[i + k] += Amplitude * (Table[Index] + Fraction * (Table[Index + 1] - Table[Index]));
+
+            // Advance the phase. The fractional part carries into the phase without rounding.
+            Remainders[k] += StepRemainder;
+
+            const uint64_t Carry = (Remainders[k] >= Denominator) ? 1 : 0;
+
+            Remainders[k] -= Carry * Denominator;
+            Phases[k] += Step + Carry;
+        }
+    }
+}
+
+/// <summary>
+/// Sets the phase increment of a tone. Frequencies that are a multiple of 1 mHz are represented exactly as a rational number of 2^-64 periods,
+/// other frequencies are rounded to the nearest multiple of the sample rate / 2^64 (1.3e-15 Hz at 48 kHz).
+/// </summary>
+void oscillator_t::SetIncrement(tone_t & tone, double frequency, uint32_t sampleRate) noexcept
+{
+    const double Millihertz = std::round(frequency * 1000.);
+
+    if (std::abs(frequency * 1000. - Millihertz) > 1e-6)
+    {
+        tone.Increment   = ToFixedPoint(frequency / sampleRate);
+        tone.Remainder   = 0;
+        tone.Denominator = 1;
+
+        return;
+    }
+
+    // Increment = F * 2^64 / D with F in mHz and D the sample rate in mHz. Both are smaller than 2^30 so no intermediate result overflows.
+    const uint64_t F = (uint64_t) Millihertz;
+    const uint64_t D = (uint64_t) sampleRate * 1000;
+
+    uint64_t Q = UINT64_MAX / D;        // 2^64 = Q * D + M
+    uint64_t M = UINT64_MAX % D + 1;
+
+    if (M == D)
+    {
+        ++Q;
+        M = 0;
+    }
+
+    tone.Increment   = F * Q + (F * M) / D;
+    tone.Remainder   = (F * M) % D;
+    tone.Denominator = D;
+}
+
+/// <summary>
+/// Calculates the exact phase of a tone at the specified frame. Integer arithmetic wraps around modulo 2^64, i.e. exactly one period.
+/// </summary>
+uint64_t oscillator_t::GetPhase(const tone_t & tone, uint64_t frameIndex, uint64_t & remainder) noexcept
+{
+    // floor(n * R / D) = q * R + floor(p * R / D) with n = q * D + p. p * R < D^2 < 2^60.
+    const uint64_t q = frameIndex / tone.Denominator;
+    const uint64_t p = frameIndex % tone.Denominator;
+
+    remainder = (p * tone.Remainder) % tone.Denominator;
+
+    return tone.Phase + frameIndex * tone.Increment + q * tone.Remainder + (p * tone.Remainder) / tone.Denominator;
+}
+
+/// <summary>
+/// Gets the exact frequency that is generated for the specified tone.
+/// </summary>
+double oscillator_t::GetFrequency(const tone_t & tone) const noexcept
+{
+    return ((double) tone.Increment + (double) tone.Remainder / (double) tone.Denominator) / TwoPow64 * _SampleRate;
+}
@@ -0,0 +1,61 @@
+
+/** $VER: Oscillator.h (2026.10.19) P. Stuer - Sine oscillators with a 64-bit fixed-point phase **/
+
+#pragma once
+
+#include "Generator.h"
+#include "Wavetable.h"
+
+#include <vector>
+
+/// <summary>
+/// Generates one or more sine waves. The phase of each oscillator is a 64-bit fixed-point fraction of a period that is calculated from the frame index,
+/// so there is no accumulated rounding error for any duration and seeking to any frame takes constant time. Frequencies with a resolution of 1 mHz
+/// are exact: the fractional part of the phase increment is kept as a rational number.
+/// </summary>
+class oscillator_t : public native_generator_t
+{
+public:
+    oscillator_t(const signal_document_t & document);
+
+    static bool IsOurGenerator(const std::string & name) noexcept;
+
+    void GetInfo(file_info & fileInfo) const noexcept override;
+
+protected:
+    void Generate(audio_sample * data, size_t frameCount) noexcept override;
+
+    void SetPosition(uint64_t frameIndex) noexcept override
+    {
+        _Position = frameIndex;
+    }
+
+private:
+    struct tone_t
+    {
+        uint64_t Increment;     // Integer part of the phase increment per frame in units of 2^-64 period
+        uint64_t Remainder;     // Fractional part of the phase increment: Remainder / Denominator
+        uint64_t Denominator;
+        uint64_t Phase;         // Phase at frame 0 in units of 2^-64 period
+        double Amplitude;
+    };
+
+    void RenderPolynomial(const tone_t & tone, double * block, size_t frameCount) const noexcept;
+    void RenderWavetable(const tone_t & tone, double * block, size_t frameCount) const noexcept;
+
+    static void SetIncrement(tone_t & tone, double frequency, uint32_t sampleRate) noexcept;
+    static uint64_t GetPhase(const tone_t & tone, uint64_t frameIndex, uint64_t & remainder) noexcept;
+
+    double GetFrequency(const tone_t & tone) const noexcept;
+
+private:
+    std::vector<tone_t> _Tones;
+    std::shared_ptr<const wavetable_t> _Wavetable;  // Only used when the table method has been selected.
+    std::vector<double> _Block;
+
+    uint64_t _Position;
+
+    static const size_t Lanes = 8;                  // Number of independent phases calculated in parallel. Allows the compiler to use 4 to 16 wide vectors.
+    static const size_t BlockSize = 256;            // Must be a multiple of Lanes
+    static const size_t WavetableSize = 65536;
+};
@@ -0,0 +1,176 @@
+
+/** $VER: OutputHash.cpp (2026.10.19) P. Stuer - Hash of the generated output **/
+
+#include "pch.h"
+
+#include "OutputHash.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+/// <summary>
+/// Starts hashing the output of the specified subsong. The golden hashes are stored in "<file>.xxh64", or "<file>.<subsong>.xxh64" for subsongs other than the first.
+/// </summary>
+void output_hash_t::Start(const char * filePath, uint32_t subsongIndex, uint32_t sampleRate, uint32_t channelCount, abort_callback & abortHandler)
+{
+    _FilePath = (subsongIndex == 0) ? std::string(filePath) + ".xxh64" : std::string(filePath) + "." + std::to_string(subsongIndex) + ".xxh64";
+
+    _FramesPerBlock = sampleRate;
+    _FrameSize = channelCount * sizeof(audio_sample);
+
+    _Hash = xxhash64_t();
+    _BlockHash = xxhash64_t();
+    _FrameCount = 0;
+    _BlockFrameCount = 0;
+    _Blocks.clear();
+
+    _IsVerifying = filesystem::g_exists(_FilePath.c_str(), abortHandler);
+
+    if (_IsVerifying)
+        ReadGoldenHashes(abortHandler);
+
+    _IsActive = true;
+}
+
+/// <summary>
+/// Adds interleaved samples to the hash.
+/// </summary>
+void output_hash_t::Update(const audio_sample * data, size_t frameCount)
+{
+    if (!_IsActive)
+        return;
+
+    while (frameCount != 0)
+    {
+        const size_t FrameCount = (size_t) std::min((uint64_t) frameCount, _FramesPerBlock - _BlockFrameCount);
+        const size_t Size = FrameCount * _FrameSize;
+
+        _Hash.Update(data, Size);
+        _BlockHash.Update(data, Size);
+
+        _FrameCount      += FrameCount;
+        _BlockFrameCount += FrameCount;
+
+        data       += Size / sizeof(audio_sample);
+        frameCount -= FrameCount;
+
+        if (_BlockFrameCount == _FramesPerBlock)
+            FinishBlock();
+    }
+}
+
+/// <summary>
+/// Finishes the hash at the end of the output. Reports the hash and writes the golden hashes or compares the output with them.
+/// </summary>
+void output_hash_t::Finish(abort_callback & abortHandler)
+{
+    if (!_IsActive)
+        return;
+
+    if (_BlockFrameCount != 0)
+        FinishBlock();
+
+    _IsActive = false;
+
+    const uint64_t Digest = _Hash.Digest();
+
+    Log.AtInfo().Write(STR_COMPONENT_NAME " output hash is %016llX (%llu frames).", Digest, _FrameCount);
+
+    if (_IsVerifying)
+    {
+        if ((Digest != _GoldenDigest) || (_FrameCount != _GoldenFrameCount))
+            throw exception_io_data(msc::FormatText("Output hash %016llX of %llu frames does not match golden hash %016llX of %llu frames", Digest, _FrameCount, _GoldenDigest, _GoldenFrameCount).c_str());
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " output matches the golden hash.");
+    }
+    else
+        WriteGoldenHashes(abortHandler);
+}
+
+/// <summary>
+/// Finishes the hash of the current block and compares it with the golden hash when verifying.
+/// </summary>
+void output_hash_t::FinishBlock()
+{
+    const uint64_t Digest = _BlockHash.Digest();
+
+    const size_t Index = _Blocks.size();
+
+    _Blocks.push_back(Digest);
+
+    _BlockHash = xxhash64_t();
+    _BlockFrameCount = 0;
+
+    if (_IsVerifying && ((Index >= _GoldenBlocks.size()) || (Digest != _GoldenBlocks[Index])))
+    {
+        _IsActive = false;
+
+        throw exception_io_data(msc::FormatText("Output differs from the golden hash between %.3f and %.3f seconds", (double) Index, (double) _FrameCount / (double) _FramesPerBlock).c_str());
+    }
+}
+
+/// <summary>
+/// Reads the golden hashes: the hash and frame count of the complete output on the first line, followed by the hash of every second.
+/// </summary>
+void output_hash_t::ReadGoldenHashes(abort_callback & abortHandler)
+{
+    service_ptr_t<file> File;
+
+    filesystem::g_open_read(File, _FilePath.c_str(), abortHandler);
+
+    std::string Text;
+
+    Text.resize((size_t) File->get_size_ex(abortHandler));
+
+    File->read_object(Text.data(), Text.size(), abortHandler);
+
+    const char * p = Text.c_str();
+    char * End = nullptr;
+
+    _GoldenDigest     = ::strtoull(p, &End, 16); p = End;
+    _GoldenFrameCount = ::strtoull(p, &End, 10);
+
+    if (End == p)
+        throw exception_io_data(msc::FormatText("Invalid golden hash file \"%s\"", _FilePath.c_str()).c_str());
+
+    _GoldenBlocks.clear();
+
+    for (p = End;;)
+    {
+        const uint64_t Digest = ::strtoull(p, &End, 16);
+
+        if (End == p)
+            break;
+
+        _GoldenBlocks.push_back(Digest);
+        p = End;
+    }
+}
+
+/// <summary>
+/// Writes the golden hashes.
+/// </summary>
+void output_hash_t::WriteGoldenHashes(abort_callback & abortHandler) const
+{
+    try
+    {
+        std::string Text = msc::FormatText("%016llX %llu\n", _Hash.Digest(), _FrameCount);
+
+        for (const auto Digest : _Blocks)
+            Text += msc::FormatText("%016llX\n", Digest);
+
+        service_ptr_t<file> File;
+
+        filesystem::g_open_write_new(File, _FilePath.c_str(), abortHandler);
+
+        File->write_object(Text.data(), Text.size(), abortHandler);
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " wrote golden hashes to \"%s\".", _FilePath.c_str());
+    }
+    catch (const std::exception & e)
+    {
+        Log.AtWarn().Write(STR_COMPONENT_NAME " failed to write golden hashes to \"%s\": %s", _FilePath.c_str(), e.what());
+    }
+}
@@ -0,0 +1,56 @@
+
+/** $VER: OutputHash.h (2026.10.19) P. Stuer - Hash of the generated output **/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "Hash.h"
+
+/// <summary>
+/// Implements a streaming hash of the generated samples to verify that a document renders identically across builds and machines.
+/// Besides the hash of the complete output a hash of every second is kept. These are written to a sidecar file ("golden" hashes) the first time a file is played.
+/// When the sidecar exists, the output is compared with it instead and playback fails at the first second that is different.
+/// </summary>
+class output_hash_t
+{
+public:
+    output_hash_t() noexcept : _IsActive(), _IsVerifying(), _FramesPerBlock(), _FrameSize(), _FrameCount(), _BlockFrameCount(), _GoldenDigest(), _GoldenFrameCount() { }
+
+    void Start(const char * filePath, uint32_t subsongIndex, uint32_t sampleRate, uint32_t channelCount, abort_callback & abortHandler);
+    void Update(const audio_sample * data, size_t frameCount);
+    void Finish(abort_callback & abortHandler);
+
+    /// <summary>
+    /// Stops hashing, e.g. because the playback position was changed.
+    /// </summary>
+    void Cancel() noexcept { _IsActive = false; }
+
+    bool IsActive() const noexcept { return _IsActive; }
+
+private:
+    void FinishBlock();
+
+    void ReadGoldenHashes(abort_callback & abortHandler);
+    void WriteGoldenHashes(abort_callback & abortHandler) const;
+
+private:
+    bool _IsActive;
+    bool _IsVerifying;
+
+    std::string _FilePath;          // Path of the sidecar file
+
+    uint64_t _FramesPerBlock;
+    size_t _FrameSize;              // Size of a frame in bytes
+
+    xxhash64_t _Hash;
+    xxhash64_t _BlockHash;
+    uint64_t _FrameCount;
+    uint64_t _BlockFrameCount;
+    std::vector<uint64_t> _Blocks;
+
+    uint64_t _GoldenDigest;
+    uint64_t _GoldenFrameCount;
+    std::vector<uint64_t> _GoldenBlocks;
+};
@@ -0,0 +1,223 @@
+
+/** $VER: ScoreCache.cpp (2026.10.19) P. Stuer - Binary cache of precompiled scores **/
+
+#include "pch.h"
+
+#include "ScoreCache.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+static_assert(sizeof(score_cache_header_t) % sizeof(double) == 0, "The events must be aligned");
+
+static const char Magic[4] = { 'F', 'I', 'S', 'S' };
+static const double IndexInterval = 1.;
+
+/// <summary>
+/// Opens the precompiled score with the specified hash. Returns nullptr if there is none or if it does not match.
+/// </summary>
+std::unique_ptr<score_cache_t> score_cache_t::Open(uint64_t hash, uint64_t scoreSize) noexcept
+{
+    try
+    {
+        const std::wstring FilePath = GetFilePath(hash);
+
+        if (FilePath.empty() || !fs::exists(FilePath))
+            return nullptr;
+
+        auto Cache = std::make_unique<score_cache_t>();
+
+        if (!Cache->_Stream.Open(FilePath, 0, 0) || (Cache->_Stream.Size() < sizeof(score_cache_header_t)))
+            return nullptr;
+
+        const uint8_t * Data = Cache->_Stream.Data();
+        const auto * Header = (const score_cache_header_t *) Data;
+
+        if ((::memcmp(Header->Magic, Magic, sizeof(Magic)) != 0) || (Header->Version != Version) || (Header->Hash != hash) || (Header->ScoreSize != scoreSize))
+            return nullptr;
+
+        // Check each count separately so a corrupt header can't overflow the size calculation.
+        const uint64_t FileSize = Cache->_Stream.Size();
+
+        if ((Header->ValueCount > FileSize / sizeof(double)) || (Header->IndexCount > FileSize / sizeof(score_cache_index_t)) || (Header->StatementsSize > FileSize) || !std::isfinite(Header->EndTime))
+            return nullptr;
+
+        const uint64_t Size = sizeof(*Header) + Header->ValueCount * sizeof(double) + Header->IndexCount * sizeof(score_cache_index_t) + Header->StatementsSize;
+
+        if (Size != FileSize)
+            return nullptr;
+
+        Cache->_Header     = Header;
+        Cache->_Events     = (const double *) (Data + sizeof(*Header));
+        Cache->_Index      = (const score_cache_index_t *) (Cache->_Events + Header->ValueCount);
+        Cache->_Statements = (const char *) (Cache->_Index + Header->IndexCount);
+
+        // The events are checked when they are streamed.
+        return Cache;
+    }
+    catch (const std::exception & e)
+    {
+        Log.AtWarn().Write(STR_COMPONENT_NAME " failed to open precompiled score: %s", e.what());
+
+        return nullptr;
+    }
+}
+
+/// <summary>
+/// Gets the offset of the first event that starts at or after the specified time. Returns an offset that is not an event if the index or the events are corrupt.
+/// </summary>
+uint64_t score_cache_t::Find(double time) const noexcept
+{
+    // Find the last time slot that starts at or before the specified time.
+    const score_cache_index_t * Tail = _Index + _Header->IndexCount;
+    const score_cache_index_t * Entry = std::upper_bound(_Index, Tail, time, [](double t, const score_cache_index_t & e) { return t < e.Time; });
+
+    if (Entry == _Index)
+        return 0;
+
+    uint64_t Offset = Entry[-1].Offset;
+
+    while (IsEvent(Offset) && (_Events[Offset + 2] < time))
+        Offset += (uint64_t) _Events[Offset] + 1;
+
+    return Offset;
+}
+
+/// <summary>
+/// Returns true if a valid event starts at the specified offset. An event must have at least the p-fields p1 to p3 and end within the events.
+/// </summary>
+bool score_cache_t::IsEvent(uint64_t offset) const noexcept
+{
+    const uint64_t ValueCount = _Header->ValueCount;
+
+    if (offset >= ValueCount)
+        return false;
+
+    const double Count = _Events[offset];
+
+    return (Count >= 3.) && (Count <= (double) MaxValueCount) && (Count == std::floor(Count)) && ((uint64_t) Count + 1 <= ValueCount - offset);
+}
+
+/// <summary>
+/// Gets the path of the precompiled score with the specified hash. Returns an empty string if the directory is not available.
+/// </summary>
+std::wstring score_cache_t::GetFilePath(uint64_t hash)
+{
+    pfc::string8 ProfilePath;
+
+    if (!foobar2000_io::extract_native_path(core_api::get_profile_path(), ProfilePath))
+        return std::wstring();
+
+    fs::path DirectoryPath = fs::path(msc::UTF8ToWide(ProfilePath.c_str(), ProfilePath.get_length())) / STR_COMPONENT_BASENAME / L"scores";
+
+    std::error_code ec;
+
+    fs::create_directories(DirectoryPath, ec);
+
+    if (ec)
+        return std::wstring();
+
+    wchar_t FileName[32];
+
+    ::swprintf_s(FileName, _countof(FileName), L"%016llx.fiss", (unsigned long long) hash);
+
+    return (DirectoryPath / FileName).wstring();
+}
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+score_cache_writer_t::score_cache_writer_t(uint64_t hash, uint64_t scoreSize) : _Header(), _IsCommitted()
+{
+    _FilePath = score_cache_t::GetFilePath(hash);
+
+    if (_FilePath.empty())
+        throw exception_io("Score cache directory is not available");
+
+    _TempFilePath = _FilePath + L".tmp";
+
+    if (!_Stream.Open(_TempFilePath, true))
+        throw exception_io("Failed to create precompiled score");
+
+    ::memcpy(_Header.Magic, Magic, sizeof(Magic));
+
+    _Header.Version       = score_cache_t::Version;
+    _Header.Hash          = hash;
+    _Header.ScoreSize     = scoreSize;
+    _Header.IndexInterval = IndexInterval;
+
+    // Reserve room for the header. It is written when the file is committed.
+    _Stream.Write(&_Header, sizeof(_Header));
+
+    _Buffer.reserve(BufferSize);
+}
+
+/// <summary>
+/// Deletes the file if it was not committed.
+/// </summary>
+score_cache_writer_t::~score_cache_writer_t() noexcept
+{
+    if (!_IsCommitted)
+    {
+        _Stream.Close();
+
+        ::DeleteFileW(_TempFilePath.c_str());
+    }
+}
+
+/// <summary>
+/// Adds an event. The events must be added in chronological order.
+/// </summary>
+void score_cache_writer_t::Add(const double * values, size_t count)
+{
+    const double Slot = std::floor(values[1] / IndexInterval) * IndexInterval;
+
+    if (_Index.empty() || (Slot > _Index.back().Time))
+        _Index.push_back({ Slot, _Header.ValueCount + _Buffer.size() });
+
+    _Buffer.push_back((double) count);
+    _Buffer.insert(_Buffer.end(), values, values + count);
+
+    ++_Header.EventCount;
+
+    if (_Buffer.size() >= BufferSize)
+        Flush();
+}
+
+/// <summary>
+/// Writes the remaining data and makes the file available.
+/// </summary>
+void score_cache_writer_t::Commit(const std::string & statements, double endTime)
+{
+    Flush();
+
+    _Stream.Write(_Index.data(), _Index.size() * sizeof(score_cache_index_t));
+    _Stream.Write(statements.data(), statements.size());
+
+    _Header.IndexCount     = _Index.size();
+    _Header.EndTime        = endTime;
+    _Header.StatementsSize = statements.size();
+
+    _Stream.Offset(0);
+    _Stream.Write(&_Header, sizeof(_Header));
+    _Stream.Close();
+
+    if (!::MoveFileExW(_TempFilePath.c_str(), _FilePath.c_str(), MOVEFILE_REPLACE_EXISTING))
+        throw exception_io("Failed to store precompiled score");
+
+    _IsCommitted = true;
+}
+
+/// <summary>
+/// Writes the buffered events.
+/// </summary>
+void score_cache_writer_t::Flush()
+{
+    _Stream.Write(_Buffer.data(), _Buffer.size() * sizeof(double));
+
+    _Header.ValueCount += _Buffer.size();
+
+    _Buffer.clear();
+}
@@ -0,0 +1,104 @@
+
+/** $VER: ScoreCache.h (2026.10.19) P. Stuer - Binary cache of precompiled scores **/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libmsc.h>
+
+/// <summary>
+/// Represents the header of a precompiled score file.
+/// The header is followed by the events, the index and the f statements of the score. Each event is stored as its number of p-fields followed by the p-fields, all as doubles.
+/// </summary>
+struct score_cache_header_t
+{
+    char Magic[4];              // "FISS"
+    uint32_t Version;
+    uint64_t Hash;              // XXH64 of the score text
+    uint64_t ScoreSize;         // Size of the score text
+    uint64_t EventCount;
+    uint64_t ValueCount;        // Number of doubles used by the events
+    uint64_t IndexCount;
+    double IndexInterval;       // Length of the time slots of the index in seconds
+    double EndTime;
+    uint64_t StatementsSize;    // Size of the f statements that are compiled with the orchestra
+};
+
+/// <summary>
+/// Represents an entry of the index of a precompiled score. There is an entry for every time slot that contains events, so the index never has more entries than the score has events.
+/// </summary>
+struct score_cache_index_t
+{
+    double Time;                // Start of the time slot
+    uint64_t Offset;            // Offset of the first event of the time slot
+};
+
+/// <summary>
+/// Implements a memory-mapped precompiled score.
+/// </summary>
+class score_cache_t
+{
+public:
+    static std::unique_ptr<score_cache_t> Open(uint64_t hash, uint64_t scoreSize) noexcept;
+
+    const double * Events() const noexcept { return _Events; }
+    uint64_t ValueCount() const noexcept { return _Header->ValueCount; }
+    uint64_t EventCount() const noexcept { return _Header->EventCount; }
+    double EndTime() const noexcept { return _Header->EndTime; }
+
+    std::string Statements() const { return std::string(_Statements, (size_t) _Header->StatementsSize); }
+
+    uint64_t Find(double time) const noexcept;
+    bool IsEvent(uint64_t offset) const noexcept;
+
+    static std::wstring GetFilePath(uint64_t hash);
+
+    static constexpr uint32_t Version = 2;
+    static constexpr uint64_t MaxValueCount = 65536;   // Maximum number of p-fields of an event
+
+private:
+    msc::memory_stream_t _Stream;
+
+    const score_cache_header_t * _Header;
+    const double * _Events;
+    const score_cache_index_t * _Index;
+    const char * _Statements;
+};
+
+/// <summary>
+/// Writes a precompiled score. The file only becomes visible to readers when it is committed.
+/// </summary>
+class score_cache_writer_t
+{
+public:
+    score_cache_writer_t(uint64_t hash, uint64_t scoreSize);
+
+    score_cache_writer_t(const score_cache_writer_t &) = delete;
+    score_cache_writer_t & operator=(const score_cache_writer_t &) = delete;
+
+    ~score_cache_writer_t() noexcept;
+
+    void Add(const double * values, size_t count);
+    void Commit(const std::string & statements, double endTime);
+
+private:
+    void Flush();
+
+private:
+    std::wstring _FilePath;
+    std::wstring _TempFilePath;
+
+    msc::file_stream_t _Stream;
+
+    score_cache_header_t _Header;
+
+    std::vector<double> _Buffer;
+    std::vector<score_cache_index_t> _Index;
+
+    bool _IsCommitted;
+
+    static constexpr size_t BufferSize = 128 * 1024;   // Number of doubles that are written at once
+};
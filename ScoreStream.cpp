@@ -0,0 +1,575 @@
+
+/** $VER: ScoreStream.cpp (2026.10.19) P. Stuer - Feeds the instrument statements of a large score to Csound while rendering **/
+
+#include "pch.h"
+
+#include "ScoreStream.h"
+#include "Configuration.h"
+#include "Hash.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+static const char * SkipToken(const char * p, const char * tail) noexcept;
+static bool ToNumber(const char * head, const char * tail, double & value) noexcept;
+static void BuildText(const char * text, const char * scoreHead, const char * scoreTail, const std::string & statements, std::string & compiledText);
+
+/// <summary>
+/// Checks if the score of the document can be streamed. If so, creates the text that is compiled by Csound: the document with the score replaced by an f0 statement that keeps Csound running while the score is streamed.
+/// Only the statements up to the first i statement are checked here. The other statements are checked when they are fed.
+/// </summary>
+bool score_stream_t::Prepare(const char * text, std::string & compiledText)
+{
+    const char * ScoreHead = ::strstr(text, "<CsScore>");
+    const char * ScoreTail = (ScoreHead != nullptr) ? ::strstr(ScoreHead, "</CsScore>") : nullptr;
+
+    if ((ScoreHead == nullptr) || (ScoreTail == nullptr) || ((size_t) (ScoreTail - ScoreHead) < MinScoreSize))
+        return false;
+
+    ScoreHead += 9;
+
+    // A tempo set on the command line changes the meaning of the start times.
+    {
+        const char * OptionsHead = ::strstr(text, "<CsOptions>");
+        const char * OptionsTail = (OptionsHead != nullptr) ? ::strstr(OptionsHead, "</CsOptions>") : nullptr;
+
+        if (OptionsTail != nullptr)
+        {
+            // Prefix the options with a space to also find an option at the start of the options.
+            const std::string Options = " " + std::string(OptionsHead + 11, OptionsTail);
+
+            if ((Options.find(" -t") != std::string::npos) || (Options.find("\t-t") != std::string::npos) || (Options.find("\n-t") != std::string::npos) || (Options.find("--tempo") != std::string::npos))
+                return false;
+        }
+    }
+
+    const uint64_t ScoreSize = (uint64_t) (ScoreTail - ScoreHead);
+
+    if (CfgScoreCache.get())
+    {
+        const uint64_t Hash = xxhash64_t::Compute(ScoreHead, (size_t) ScoreSize);
+
+        _Cache = score_cache_t::Open(Hash, ScoreSize);
+
+        if (_Cache)
+        {
+            BuildText(text, ScoreHead, ScoreTail, _Cache->Statements(), compiledText);
+
+            _EventCount = (size_t) _Cache->EventCount();
+
+            Rewind();
+
+            Log.AtInfo().Write(STR_COMPONENT_NAME " streams %zu precompiled score events (%.3f s).", _EventCount, _Cache->EndTime());
+
+            return true;
+        }
+
+        try
+        {
+            _Writer = std::make_unique<score_cache_writer_t>(Hash, ScoreSize);
+        }
+        catch (const std::exception & e)
+        {
+            Log.AtWarn().Write(STR_COMPONENT_NAME " can't precompile score: %s", e.what());
+        }
+    }
+
+    // Check the statements up to the first i statement. Scores that start with a statement that can't be streamed, e.g. a macro or a tempo statement, are left to Csound.
+    for (const char * Line = ScoreHead; Line < ScoreTail;)
+    {
+        const char * LineTail = Line;
+
+        while ((LineTail < ScoreTail) && (*LineTail != '\n'))
+            ++LineTail;
+
+        const char * p = Line;
+
+        while ((p < LineTail) && std::isspace((unsigned char) *p))
+            ++p;
+
+        if ((p < LineTail) && (*p != ';'))
+        {
+            statement_t Statement;
+
+            if ((*p == 'i') && ParseStatement(p, LineTail, Statement))
+                break;
+
+            if ((*p != 'f') || (std::string(p, LineTail).find("/*") != std::string::npos))
+            {
+                _Writer.reset();
+
+                return false;
+            }
+        }
+
+        Line = (LineTail < ScoreTail) ? LineTail + 1 : ScoreTail;
+    }
+
+    BuildText(text, ScoreHead, ScoreTail, std::string(), compiledText);
+
+    _Text = text;
+    _Head = (size_t) (ScoreHead - text);
+    _Tail = (size_t) (ScoreTail - text);
+    _Curr = _Head;
+
+    Rewind();
+
+    Log.AtInfo().Write(STR_COMPONENT_NAME " streams the score (%.1f MB).", (double) ScoreSize / (1024. * 1024.));
+
+    return true;
+}
+
+/// <summary>
+/// Takes ownership of the text that was prepared.
+/// </summary>
+void score_stream_t::SetText(std::string && text) noexcept
+{
+    if (_Cache)
+        return; // A precompiled score does not need the text.
+
+    _String = std::move(text);
+    _Text = _String.c_str();
+}
+
+/// <summary>
+/// Takes ownership of the memory-mapped text that was prepared.
+/// </summary>
+void score_stream_t::SetText(std::unique_ptr<msc::memory_stream_t> && stream) noexcept
+{
+    if (_Cache)
+        return;
+
+    _Stream = std::move(stream);
+    _Text = (const char *) _Stream->Data();
+}
+
+/// <summary>
+/// Moves back to the first statement. A score that is rewound before it has been streamed completely is not precompiled.
+/// </summary>
+void score_stream_t::Rewind() noexcept
+{
+    if (_Cache)
+    {
+        _Curr = (size_t) _Cache->Find(0.);
+        _EndTime = _Cache->EndTime();
+    }
+    else
+    {
+        if (_Curr != _Head)
+            _Writer.reset();
+
+        _Curr = _Head;
+        _EndTime = 0.;
+        _EventCount = 0;
+    }
+
+    _NextTime = -1.;
+    _LastTime = 0.;
+    _IsExhausted = false;
+}
+
+/// <summary>
+/// Sends the statements that start before the look-ahead time to Csound. The start times are made relative to the current score time.
+/// </summary>
+void score_stream_t::Feed(CSOUND * csound, double scoreTime) noexcept
+{
+    if (_NextTime > scoreTime + LookAhead)
+        return;
+
+    if (_Cache)
+        FeedEvents(csound, scoreTime);
+    else
+        FeedText(csound, scoreTime);
+}
+
+/// <summary>
+/// Sends the statements from the text of the score.
+/// </summary>
+void score_stream_t::FeedText(CSOUND * csound, double scoreTime) noexcept
+{
+    const double Limit = scoreTime + LookAhead;
+
+    const char * Text = _Text;
+    const char * Tail = Text + _Tail;
+
+    while (_Curr < _Tail)
+    {
+        const char * Line = Text + _Curr;
+        const char * LineTail = (const char *) ::memchr(Line, '\n', (size_t) (Tail - Line));
+
+        if (LineTail == nullptr)
+            LineTail = Tail;
+
+        const char * p = Line;
+
+        while ((p < LineTail) && std::isspace((unsigned char) *p))
+            ++p;
+
+        if ((p < LineTail) && (*p != ';'))
+        {
+            if ((*p != 'i') && (*p != 'f') && (*p != 'e'))
+            {
+                Stop(p, LineTail);
+                return;
+            }
+
+            if (*p == 'e')
+            {
+                const char * Value = p + 1;
+
+                while ((Value < LineTail) && std::isspace((unsigned char) *Value))
+                    ++Value;
+
+                const char * ValueTail = SkipToken(Value, LineTail);
+
+                double Time;
+
+                if ((Value < ValueTail) && (*Value != ';'))
+                {
+                    if (!ToNumber(Value, ValueTail, Time))
+                    {
+                        Stop(p, LineTail);
+                        return;
+                    }
+
+                    _EndTime = Time;
+                }
+
+                break;
+            }
+
+            // An f statement only needs a table number and a start time. The other p-fields are sent as they are.
+            statement_t Statement;
+
+            bool IsF0 = false;
+
+            if (*p == 'f')
+            {
+                Statement.P1Head = p + 1;
+
+                while ((Statement.P1Head < LineTail) && std::isspace((unsigned char) *Statement.P1Head))
+                    ++Statement.P1Head;
+
+                Statement.P1Tail = SkipToken(Statement.P1Head, LineTail);
+
+                const char * P2Head = Statement.P1Tail;
+
+                while ((P2Head < LineTail) && std::isspace((unsigned char) *P2Head))
+                    ++P2Head;
+
+                Statement.RestHead = SkipToken(P2Head, LineTail);
+                Statement.RestTail = LineTail;
+
+                double TableNumber;
+
+                if (!ToNumber(Statement.P1Head, Statement.P1Tail, TableNumber) || !ToNumber(P2Head, Statement.RestHead, Statement.P2) || (std::string(p, LineTail).find("/*") != std::string::npos))
+                {
+                    Stop(p, LineTail);
+                    return;
+                }
+
+                IsF0 = (TableNumber == 0.);
+            }
+            else
+            if (!ParseStatement(p, LineTail, Statement, _Writer ? &_Values : nullptr) || !(Statement.P3 >= 0.))
+            {
+                Stop(p, LineTail);
+                return;
+            }
+
+            if (!std::isfinite(Statement.P2) || (Statement.P2 < _LastTime))
+            {
+                Stop(p, LineTail);
+                return;
+            }
+
+            _NextTime = Statement.P2;
+
+            if (_NextTime > Limit)
+                return;
+
+            _LastTime = Statement.P2;
+
+            if (*p == 'i')
+            {
+                _EndTime = std::max(_EndTime, Statement.P2 + Statement.P3);
+                ++_EventCount;
+
+                if (_Writer)
+                {
+                    try
+                    {
+                        // Strings can't be stored as p-fields.
+                        if (Statement.HasStrings)
+                            _Writer.reset();
+                        else
+                            _Writer->Add(_Values.data(), _Values.size());
+                    }
+                    catch (const std::exception & e)
+                    {
+                        Log.AtWarn().Write(STR_COMPONENT_NAME " failed to precompile score: %s", e.what());
+
+                        _Writer.reset();
+                    }
+                }
+            }
+            else
+            {
+                // The f statements are compiled with the orchestra when the score is precompiled.
+                if (_Writer)
+                {
+                    _Statements.append(p, LineTail);
+                    _Statements += '\n';
+                }
+
+                // An f0 statement only extends the performance.
+                if (IsF0)
+                    _EndTime = std::max(_EndTime, Statement.P2);
+            }
+
+            if (!IsF0)
+            {
+                _Event.assign(1, *p);
+                _Event += ' ';
+                _Event.append(Statement.P1Head, Statement.P1Tail);
+                _Event += msc::FormatText(" %.17g ", std::max(Statement.P2 - scoreTime, 0.));
+                _Event.append(Statement.RestHead, Statement.RestTail);
+
+                ::csoundEventString(csound, _Event.c_str(), 0);
+            }
+        }
+
+        _Curr = (size_t) (LineTail - Text) + ((LineTail < Tail) ? 1 : 0);
+    }
+
+    Finish();
+}
+
+/// <summary>
+/// Sends the events of a precompiled score. Streaming stops at the first corrupt event.
+/// </summary>
+void score_stream_t::FeedEvents(CSOUND * csound, double scoreTime) noexcept
+{
+    const double Limit = scoreTime + LookAhead;
+
+    const double * Events = _Cache->Events();
+    const size_t ValueCount = (size_t) _Cache->ValueCount();
+
+    while (_Curr != ValueCount)
+    {
+        if (!_Cache->IsEvent(_Curr))
+        {
+            Log.AtWarn().Write(STR_COMPONENT_NAME " stops streaming corrupt precompiled score at offset %zu.", _Curr);
+
+            // End the playback once the events that have already been sent have started.
+            _EndTime = std::min(_EndTime, Limit);
+            break;
+        }
+
+        const size_t Count = (size_t) Events[_Curr];
+        const double * Values = Events + _Curr + 1;
+
+        _NextTime = Values[1];
+
+        if (_NextTime > Limit)
+            return;
+
+        _Values.assign(Values, Values + Count);
+        _Values[1] = std::max(_NextTime - scoreTime, 0.);
+
+        ::csoundEvent(csound, CS_INSTR_EVENT, _Values.data(), (int) Count, 0);
+
+        _Curr += Count + 1;
+    }
+
+    _NextTime = std::numeric_limits<double>::max();
+    _IsExhausted = true;
+}
+
+/// <summary>
+/// Marks the end of the score. Stores the score in the precompiled format if it has been streamed completely from the start.
+/// </summary>
+void score_stream_t::Finish() noexcept
+{
+    _NextTime = std::numeric_limits<double>::max();
+    _IsExhausted = true;
+
+    if (!_Writer)
+        return;
+
+    try
+    {
+        _Writer->Commit(_Statements, _EndTime);
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " precompiled %zu score events (%.3f s).", _EventCount, _EndTime);
+    }
+    catch (const std::exception & e)
+    {
+        Log.AtWarn().Write(STR_COMPONENT_NAME " failed to precompile score: %s", e.what());
+    }
+
+    _Writer.reset();
+}
+
+/// <summary>
+/// Stops streaming at a statement that can't be streamed. The events that have already been sent are played to their end.
+/// </summary>
+void score_stream_t::Stop(const char * line, const char * lineTail) noexcept
+{
+    Log.AtWarn().Write(STR_COMPONENT_NAME " stops streaming the score at \"%.*s\". Statements that can't be streamed must not be used in scores larger than 256 KB.", (int) std::min<ptrdiff_t>(lineTail - line, 64), line);
+
+    _Writer.reset();
+
+    _NextTime = std::numeric_limits<double>::max();
+    _IsExhausted = true;
+}
+
+/// <summary>
+/// Parses an i statement. Returns false if it uses any feature of the score language that prevents it from being streamed.
+/// </summary>
+bool score_stream_t::ParseStatement(const char * head, const char * tail, statement_t & statement, std::vector<double> * values) noexcept
+{
+    // Ignore a trailing comment.
+    {
+        bool IsQuoted = false;
+
+        for (const char * p = head; p < tail; ++p)
+        {
+            if (*p == '"')
+                IsQuoted = !IsQuoted;
+            else
+            if ((*p == ';') && !IsQuoted)
+            {
+                tail = p;
+                break;
+            }
+        }
+    }
+
+    const char * p = head + 1;
+
+    while ((p < tail) && std::isspace((unsigned char) *p))
+        ++p;
+
+    statement.P1Head = p;
+    statement.P1Tail = SkipToken(statement.P1Head, tail);
+
+    double Value = 0.;
+
+    if ((statement.P1Head == statement.P1Tail) || ((*statement.P1Head != '"') && !ToNumber(statement.P1Head, statement.P1Tail, Value)))
+        return false;
+
+    statement.HasStrings = (*statement.P1Head == '"');
+
+    if (values != nullptr)
+    {
+        values->clear();
+        values->push_back(Value);
+    }
+
+    const char * P2Head = statement.P1Tail;
+
+    while ((P2Head < tail) && std::isspace((unsigned char) *P2Head))
+        ++P2Head;
+
+    const char * P2Tail = SkipToken(P2Head, tail);
+
+    if (!ToNumber(P2Head, P2Tail, statement.P2))
+        return false;
+
+    if (values != nullptr)
+        values->push_back(statement.P2);
+
+    statement.RestHead = P2Tail;
+    statement.RestTail = tail;
+
+    // Check the remaining p-fields. Only numbers and strings can be streamed.
+    bool IsFirst = true;
+
+    for (p = P2Tail; p < tail; )
+    {
+        while ((p < tail) && std::isspace((unsigned char) *p))
+            ++p;
+
+        if (p == tail)
+            break;
+
+        const char * TokenTail = SkipToken(p, tail);
+
+        if (*p == '"')
+        {
+            if (IsFirst || (TokenTail[-1] != '"') || (TokenTail - p < 2))
+                return false;
+
+            statement.HasStrings = true;
+        }
+        else
+        {
+            if (!ToNumber(p, TokenTail, Value))
+                return false;
+
+            if (values != nullptr)
+                values->push_back(Value);
+        }
+
+        if (IsFirst)
+            statement.P3 = Value;
+
+        IsFirst = false;
+        p = TokenTail;
+    }
+
+    return !IsFirst;
+}
+
+/// <summary>
+/// Creates the text that is compiled by Csound. The f0 statement keeps Csound running until the stream has finished.
+/// </summary>
+static void BuildText(const char * text, const char * scoreHead, const char * scoreTail, const std::string & statements, std::string & compiledText)
+{
+    compiledText.reserve((size_t) (scoreHead - text) + statements.size() + ::strlen(scoreTail) + 16);
+
+    compiledText.assign(text, scoreHead);
+    compiledText += '\n';
+    compiledText += statements;
+    compiledText += "f 0 z\n";
+    compiledText += scoreTail;
+}
+
+/// <summary>
+/// Returns a pointer to the end of the token that starts at the specified position. A token is a string literal or a sequence of non-space characters.
+/// </summary>
+static const char * SkipToken(const char * p, const char * tail) noexcept
+{
+    if ((p < tail) && (*p == '"'))
+    {
+        ++p;
+
+        while ((p < tail) && (*p != '"'))
+            ++p;
+
+        return (p < tail) ? p + 1 : p;
+    }
+
+    while ((p < tail) && !std::isspace((unsigned char) *p))
+        ++p;
+
+    return p;
+}
+
+/// <summary>
+/// Converts a token to a number. Returns false if the token is not a plain number.
+/// </summary>
+static bool ToNumber(const char * head, const char * tail, double & value) noexcept
+{
+    if ((head == tail) || !(std::isdigit((unsigned char) *head) || (*head == '-') || (*head == '.')))
+        return false;
+
+    char * End;
+
+    value = std::strtod(head, &End);
+
+    return End == tail;
+}
@@ -0,0 +1,86 @@
+
+/** $VER: ScoreStream.h (2026.10.19) P. Stuer - Feeds the instrument statements of a large score to Csound while rendering **/
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <csound.h>
+#include <libmsc.h>
+
+#include "ScoreCache.h"
+
+/// <summary>
+/// Streams the instrument statements of a large score to Csound just ahead of the playback position, so Csound doesn't have to parse and sort the complete score before rendering the first sample.
+/// Only simple scores are streamed: i, f and e statements with explicit values, in chronological order and without carry, ramps, macros, sections or tempo changes.
+/// The statements are parsed and checked only when they are fed, so the time to the first sample doesn't depend on the length of the score. Streaming stops at the first statement that can't be streamed.
+/// Scores without strings are also stored in a precompiled binary format when they have been streamed completely. Later opens of the same score only map that file instead of parsing the score.
+/// </summary>
+class score_stream_t
+{
+public:
+    score_stream_t() noexcept : _Text(), _Head(), _Tail(), _Curr(), _NextTime(-1.), _LastTime(), _EndTime(), _IsExhausted(), _EventCount() { }
+
+    bool Prepare(const char * text, std::string & compiledText);
+
+    void SetText(std::string && text) noexcept;
+    void SetText(std::unique_ptr<msc::memory_stream_t> && stream) noexcept;
+
+    void Rewind() noexcept;
+    void Feed(CSOUND * csound, double scoreTime) noexcept;
+
+    /// <summary>
+    /// Returns true if all statements have been fed and the last event has ended.
+    /// </summary>
+    bool IsFinished(double scoreTime) const noexcept { return _IsExhausted && (scoreTime >= _EndTime); }
+
+    /// <summary>
+    /// Gets the number of events of a precompiled score, 0 if the events are read from the text.
+    /// </summary>
+    size_t GetEventCount() const noexcept { return _Cache ? _EventCount : 0; }
+
+private:
+    struct statement_t
+    {
+        const char * P1Head;    // Instrument number or name
+        const char * P1Tail;
+        double P2;              // Start time
+        double P3;              // Duration
+        const char * RestHead;  // Remaining p-fields, starting with p3
+        const char * RestTail;
+        bool HasStrings;
+    };
+
+    static bool ParseStatement(const char * head, const char * tail, statement_t & statement, std::vector<double> * values = nullptr) noexcept;
+
+    void FeedText(CSOUND * csound, double scoreTime) noexcept;
+    void FeedEvents(CSOUND * csound, double scoreTime) noexcept;
+    void Finish() noexcept;
+    void Stop(const char * line, const char * lineTail) noexcept;
+
+private:
+    const char * _Text;
+    std::string _String;
+    std::unique_ptr<msc::memory_stream_t> _Stream;
+    std::unique_ptr<score_cache_t> _Cache;
+    std::unique_ptr<score_cache_writer_t> _Writer;
+
+    size_t _Head;           // Offset of the start of the score
+    size_t _Tail;           // Offset of the end of the score
+    size_t _Curr;           // Offset of the next statement or, for a precompiled score, of the next event
+
+    double _NextTime;       // Start time of the next statement, negative if not parsed yet
+    double _LastTime;       // Start time of the last statement that was fed
+    double _EndTime;        // End time of the events that have been fed
+    bool _IsExhausted;      // True if all statements have been fed
+    size_t _EventCount;
+
+    std::string _Statements; // f statements of the score, stored with a precompiled score
+
+    std::string _Event;
+    std::vector<double> _Values;
+
+    static constexpr size_t MinScoreSize = 256 * 1024;  // Smaller scores are left to Csound.
+    static constexpr double LookAhead = 1.;             // Number of seconds that events are sent ahead of their start time.
+};
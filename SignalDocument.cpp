@@ -0,0 +1,172 @@
+
+/** $VER: SignalDocument.cpp (2026.10.19) P. Stuer - Native signal document (.sig) **/
+
+#include "pch.h"
+
+#include "SignalDocument.h"
+
+#pragma hdrstop
+
+static std::string Trim(const char * head, const char * tail) noexcept;
+
+/// <summary>
+/// Parses the specified text. Empty lines and text following a '#' or ';' are ignored.
+/// </summary>
+void signal_document_t::Parse(const char * text, size_t size)
+{
+    const char * Tail = text + size;
+
+    if ((size >= 3) && (::memcmp(text, "\xEF\xBB\xBF", 3) == 0))
+        text += 3; // Skip the UTF-8 BOM.
+
+    size_t LineNumber = 0;
+
+    while (text < Tail)
+    {
+        const char * EndOfLine = (const char *) ::memchr(text, '\n', (size_t) (Tail - text));
+
+        if (EndOfLine == nullptr)
+            EndOfLine = Tail;
+
+        ++LineNumber;
+
+        const char * EndOfData = text;
+
+        while ((EndOfData < EndOfLine) && (*EndOfData != '#') && (*EndOfData != ';'))
+            ++EndOfData;
+
+        const char * Separator = (const char *) ::memchr(text, '=', (size_t) (EndOfData - text));
+
+        if (Separator != nullptr)
+        {
+            std::string Key = Trim(text, Separator);
+
+            std::transform(Key.begin(), Key.end(), Key.begin(), [](char c) { return (char) std::tolower((unsigned char) c); });
+
+            if (Key.empty())
+                throw exception_io_data(msc::FormatText("Missing key in line %zu", LineNumber).c_str());
+
+            _Values[Key] = Trim(Separator + 1, EndOfData);
+        }
+        else
+        if (!Trim(text, EndOfData).empty())
+            throw exception_io_data(msc::FormatText("Expected \"key = value\" in line %zu", LineNumber).c_str());
+
+        text = EndOfLine + 1;
+    }
+}
+
+/// <summary>
+/// Gets the value of the specified key as a string.
+/// </summary>
+std::string signal_document_t::GetString(const char * key, const char * defaultValue) const
+{
+    auto Item = _Values.find(key);
+
+    if (Item == _Values.end())
+        return defaultValue;
+
+    return Item->second;
+}
+
+/// <summary>
+/// Gets the value of the specified key as a floating point number.
+/// </summary>
+double signal_document_t::GetDouble(const char * key, double defaultValue, double minValue, double maxValue) const
+{
+    auto Item = _Values.find(key);
+
+    if (Item == _Values.end())
+        return defaultValue;
+
+    const char * Text = Item->second.c_str();
+    char * End = nullptr;
+
+    double Value = ::strtod(Text, &End);
+
+    if ((End == Text) || (*End != '\0') || !std::isfinite(Value))
+        throw exception_io_data(msc::FormatText("Invalid value \"%s\" for \"%s\"", Text, key).c_str());
+
+    if ((Value < minValue) || (Value > maxValue))
+        throw exception_io_data(msc::FormatText("Value of \"%s\" must be between %g and %g", key, minValue, maxValue).c_str());
+
+    return Value;
+}
+
+/// <summary>
+/// Gets the value of the specified key as an integer.
+/// </summary>
+int64_t signal_document_t::GetInteger(const char * key, int64_t defaultValue, int64_t minValue, int64_t maxValue) const
+{
+    auto Item = _Values.find(key);
+
+    if (Item == _Values.end())
+        return defaultValue;
+
+    const char * Text = Item->second.c_str();
+    char * End = nullptr;
+
+    int64_t Value = ::strtoll(Text, &End, 0);
+
+    if ((End == Text) || (*End != '\0'))
+        throw exception_io_data(msc::FormatText("Invalid value \"%s\" for \"%s\"", Text, key).c_str());
+
+    if ((Value < minValue) || (Value > maxValue))
+        throw exception_io_data(msc::FormatText("Value of \"%s\" must be between %lld and %lld", key, minValue, maxValue).c_str());
+
+    return Value;
+}
+
+/// <summary>
+/// Gets the value of the specified key as a comma-separated list of floating point numbers.
+/// </summary>
+std::vector<double> signal_document_t::GetDoubles(const char * key) const
+{
+    std::vector<double> Values;
+
+    auto Item = _Values.find(key);
+
+    if (Item == _Values.end())
+        return Values;
+
+    const char * Text = Item->second.c_str();
+
+    while (*Text != '\0')
+    {
+        char * End = nullptr;
+
+        double Value = ::strtod(Text, &End);
+
+        if ((End == Text) || !std::isfinite(Value))
+            throw exception_io_data(msc::FormatText("Invalid list \"%s\" for \"%s\"", Item->second.c_str(), key).c_str());
+
+        Values.push_back(Value);
+
+        while (std::isspace((unsigned char) *End))
+            ++End;
+
+        if (*End == ',')
+            ++End;
+        else
+        if (*End != '\0')
+            throw exception_io_data(msc::FormatText("Invalid list \"%s\" for \"%s\"", Item->second.c_str(), key).c_str());
+
+        Text = End;
+    }
+
+    return Values;
+}
+
+/// <summary>
+/// Returns the text between head and tail without leading and trailing white space.
+/// </summary>
+static std::string Trim(const char * head, const char * tail) noexcept
+{
+    while ((head < tail) && std::isspace((unsigned char) *head))
+        ++head;
+
+    while ((tail > head) && std::isspace((unsigned char) tail[-1]))
+        --tail;
+
+    return std::string(head, (size_t) (tail - head));
+}
@@ -0,0 +1,39 @@
+
+/** $VER: SignalDocument.h (2026.10.19) P. Stuer - Native signal document (.sig) **/
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+/// <summary>
+/// Represents a signal document: a list of "key = value" lines that describe the signal to generate.
+/// </summary>
+class signal_document_t
+{
+public:
+    signal_document_t() noexcept { }
+
+    void Parse(const char * text, size_t size);
+
+    bool Has(const char * key) const noexcept
+    {
+        return _Values.find(key) != _Values.end();
+    }
+
+    /// <summary>
+    /// Sets the value of the specified key. The key must be lower case.
+    /// </summary>
+    void Set(const char * key, const std::string & value)
+    {
+        _Values[key] = value;
+    }
+
+    std::string GetString(const char * key, const char * defaultValue = "") const;
+    double GetDouble(const char * key, double defaultValue, double minValue, double maxValue) const;
+    int64_t GetInteger(const char * key, int64_t defaultValue, int64_t minValue, int64_t maxValue) const;
+    std::vector<double> GetDoubles(const char * key) const;
+
+private:
+    std::map<std::string, std::string> _Values;
+};
@@ -0,0 +1,115 @@
+
+/** $VER: SignalStatistics.cpp (2026.10.19) P. Stuer - Running statistics of the generated signal **/
+
+#include "pch.h"
+
+#include "SignalStatistics.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+/// <summary>
+/// Resets the statistics. The block size is the maximum number of interleaved samples that is passed to Process() and must be a multiple of the channel count.
+/// </summary>
+void signal_statistics_t::Reset(size_t blockSize, uint32_t channelCount)
+{
+    _Sum    .assign(blockSize, 0.);
+    _Squares.assign(blockSize, 0.);
+    _Peak   .assign(blockSize, 0.);
+    _Clipped.assign(blockSize, 0.);
+
+    _ChannelCount = channelCount;
+    _FrameCount = 0;
+}
+
+/// <summary>
+/// Copies a block of samples and updates the statistics. Only the specified number of samples is copied and counted. It must be a multiple of the channel count.
+/// </summary>
+void signal_statistics_t::Process(audio_sample * __restrict dst, const audio_sample * __restrict src, size_t sampleCount) noexcept
+{
+    const size_t Size = std::min(sampleCount, _Sum.size());
+
+    double * __restrict Sum     = _Sum.data();
+    double * __restrict Squares = _Squares.data();
+    double * __restrict Peak    = _Peak.data();
+    double * __restrict Clipped = _Clipped.data();
+
+    for (size_t i = 0; i < Size; ++i)
+    {
+        const double Value = src[i];
+        const double Magnitude = std::abs(Value);
+
+        dst[i] = (audio_sample) Value;
+
+        Sum[i]     += Value;
+        Squares[i] += Value * Value;
+        Peak[i]     = std::max(Peak[i], Magnitude);
+        Clipped[i] += (Magnitude > 1.) ? 1. : 0.;
+    }
+
+    _FrameCount += Size / _ChannelCount;
+}
+
+/// <summary>
+/// Gets the statistics of each channel.
+/// </summary>
+std::vector<channel_statistics_t> signal_statistics_t::GetChannels() const
+{
+    std::vector<channel_statistics_t> Channels(_ChannelCount);
+
+    std::vector<double> Sum(_ChannelCount);
+    std::vector<double> Squares(_ChannelCount);
+
+    for (size_t i = 0; i < _Sum.size(); ++i)
+    {
+        auto & Channel = Channels[i % _ChannelCount];
+
+        Sum[i % _ChannelCount]     += _Sum[i];
+        Squares[i % _ChannelCount] += _Squares[i];
+
+        Channel.Peak = std::max(Channel.Peak, _Peak[i]);
+        Channel.ClippedSamples += (uint64_t) _Clipped[i];
+    }
+
+    const uint64_t FrameCount = GetFrameCount();
+
+    if (FrameCount == 0)
+        return Channels;
+
+    for (size_t i = 0; i < Channels.size(); ++i)
+    {
+        auto & Channel = Channels[i];
+
+        Channel.DC = Sum[i] / (double) FrameCount;
+        Channel.RMS = std::sqrt(Squares[i] / (double) FrameCount);
+        Channel.CrestFactor = (Channel.RMS > 0.) ? Channel.Peak / Channel.RMS : 0.;
+    }
+
+    return Channels;
+}
+
+/// <summary>
+/// Writes a summary of the statistics to the console.
+/// </summary>
+void signal_statistics_t::Write() const noexcept
+{
+    try
+    {
+        const auto Channels = GetChannels();
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " generated %llu frames.", GetFrameCount());
+
+        for (size_t i = 0; i < Channels.size(); ++i)
+        {
+            const auto & Channel = Channels[i];
+
+            Log.AtInfo().Write(STR_COMPONENT_NAME " Channel %zu: Peak %.2f dBFS, RMS %.2f dBFS, DC offset %.6f, crest factor %.2f dB, %llu clipped samples.", i + 1,
+                ToDecibels(Channel.Peak), ToDecibels(Channel.RMS), Channel.DC, ToDecibels(Channel.CrestFactor), Channel.ClippedSamples);
+        }
+    }
+    catch (...)
+    {
+    }
+}
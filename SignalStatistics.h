@@ -0,0 +1,54 @@
+
+/** $VER: SignalStatistics.h (2026.10.19) P. Stuer - Running statistics of the generated signal **/
+
+#pragma once
+
+#include <vector>
+
+/// <summary>
+/// Represents the statistics of one channel.
+/// </summary>
+struct channel_statistics_t
+{
+    double Peak;                // Absolute peak value (1.0 = 0 dBFS)
+    double RMS;                 // Root mean square value
+    double DC;                  // Mean value
+    double CrestFactor;         // Peak / RMS
+    uint64_t ClippedSamples;    // Number of samples with an absolute value greater than 1.0
+};
+
+/// <summary>
+/// Implements running statistics of an interleaved signal that are updated while the samples are copied to the output.
+/// The statistics are accumulated per sample position in a block ("lane") so the inner loop has no dependencies between samples and can be vectorized. The lanes are folded into channels only when the statistics are read.
+/// </summary>
+class signal_statistics_t
+{
+public:
+    signal_statistics_t() noexcept : _ChannelCount(), _FrameCount() { }
+
+    void Reset(size_t blockSize, uint32_t channelCount);
+
+    void Process(audio_sample * __restrict dst, const audio_sample * __restrict src, size_t sampleCount) noexcept;
+
+    std::vector<channel_statistics_t> GetChannels() const;
+
+    uint64_t GetFrameCount() const noexcept { return _FrameCount; }
+
+    void Write() const noexcept;
+
+    /// <summary>
+    /// Converts a value to decibels. Silence is reported as the lowest level instead of -inf.
+    /// </summary>
+    static double ToDecibels(double value) noexcept { return (value > 0.) ? std::max(20. * std::log10(value), MinDecibels) : MinDecibels; }
+
+    static constexpr double MinDecibels = -200.;
+
+private:
+    std::vector<double> _Sum;
+    std::vector<double> _Squares;
+    std::vector<double> _Peak;
+    std::vector<double> _Clipped;
+
+    uint32_t _ChannelCount;
+    uint64_t _FrameCount;
+};
@@ -0,0 +1,311 @@
+
+/** $VER: SpectrumVerifier.cpp (2026.10.19) P. Stuer - Verifies the spectrum of the generated output **/
+
+#include "pch.h"
+
+#include "SpectrumVerifier.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#include <numbers>
+
+#pragma hdrstop
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+spectrum_verifier_t::spectrum_verifier_t() noexcept : _IsActive(), _SampleRate(), _ChannelCount(), _Channel(), _SegmentSize(), _Fundamental(), _MaxTHD(), _Slope(), _SlopeTolerance(), _MinSlopeFrequency(), _MaxSlopeFrequency(), _IsDone(), _SampleCount(), _SegmentCount()
+{
+}
+
+/// <summary>
+/// Starts the verification. The following keys of the specification are supported:
+///   channel         = 1-based channel to analyze (default 1)
+///   block_size      = Number of samples per FFT, a power of 2 (default 65536)
+///   fundamental     = Expected frequency of the strongest component in Hz, within one bin
+///   thd             = Maximum total harmonic distortion of the fundamental in dB, using the harmonics up to the 10th
+///   slope           = Expected slope of the spectrum in dB per octave, e.g. -3 for pink noise
+///   slope_tolerance = Allowed deviation of the slope in dB per octave (default 0.5)
+///   slope_range     = Frequency range in Hz used to fit the slope (default 50, 10000)
+/// </summary>
+void spectrum_verifier_t::Start(const signal_document_t & spec, uint32_t sampleRate, uint32_t channelCount)
+{
+    Cancel();
+
+    _SampleRate   = sampleRate;
+    _ChannelCount = channelCount;
+    _Channel      = (uint32_t) spec.GetInteger("channel", 1, 1, channelCount) - 1;
+    _SegmentSize  = (size_t) spec.GetInteger("block_size", 65536, 1024, 1048576);
+
+    if (!std::has_single_bit(_SegmentSize))
+        throw exception_io_data("Spectrum block size must be a power of 2");
+
+    const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+    _Fundamental    = spec.Has("fundamental") ? spec.GetDouble("fundamental", 0., 0., sampleRate / 2.) : NaN;
+    _MaxTHD         = spec.Has("thd")         ? spec.GetDouble("thd", 0., -200., 0.) : NaN;
+    _Slope          = spec.Has("slope")       ? spec.GetDouble("slope", 0., -100., 100.) : NaN;
+    _SlopeTolerance = spec.GetDouble("slope_tolerance", .5, 0., 100.);
+
+    const auto SlopeRange = spec.GetDoubles("slope_range");
+
+    _MinSlopeFrequency = (SlopeRange.size() > 0) ? SlopeRange[0] : 50.;
+    _MaxSlopeFrequency = (SlopeRange.size() > 1) ? SlopeRange[1] : std::min(10000., sampleRate / 2.);
+
+    if (!std::isnan(_MaxTHD) && std::isnan(_Fundamental))
+        throw exception_io_data("Spectrum specification requires a fundamental to check the THD");
+
+    _FFT = std::make_unique<real_fft_t>(_SegmentSize);
+
+    _Window.resize(_SegmentSize);
+
+    for (size_t i = 0; i < _SegmentSize; ++i)
+        _Window[i] = .5 - .5 * std::cos(2. * std::numbers::pi * (double) i / (double) _SegmentSize);
+
+    _Segment.assign(_SegmentSize, 0.);
+    _Windowed.resize(_SegmentSize);
+    _Spectrum.resize(_SegmentSize / 2 + 1);
+    _Power.assign(_SegmentSize / 2 + 1, 0.);
+    _SampleCount = 0;
+    _SegmentCount = 0;
+
+    _Pending.clear();
+    _Pending.reserve(_SegmentSize / 2);
+
+    _Queue.clear();
+    _IsDone = false;
+
+    _Thread = std::thread(&spectrum_verifier_t::Run, this);
+
+    _IsActive = true;
+}
+
+/// <summary>
+/// Passes the samples of the analyzed channel to the worker thread, half a block at a time.
+/// </summary>
+void spectrum_verifier_t::Update(const audio_sample * data, size_t frameCount)
+{
+    if (!_IsActive)
+        return;
+
+    const size_t HopSize = _SegmentSize / 2;
+
+    data += _Channel;
+
+    for (size_t i = 0; i < frameCount; ++i, data += _ChannelCount)
+    {
+        _Pending.push_back((double) *data);
+
+        if (_Pending.size() == HopSize)
+        {
+            {
+                std::lock_guard Lock(_Mutex);
+
+                _Queue.push_back(std::move(_Pending));
+            }
+
+            _Condition.notify_one();
+
+            _Pending = std::vector<double>();
+            _Pending.reserve(HopSize);
+        }
+    }
+}
+
+/// <summary>
+/// Waits for the worker thread to analyze the remaining samples and evaluates the assertions. Throws if an assertion fails.
+/// </summary>
+void spectrum_verifier_t::Finish()
+{
+    if (!_IsActive)
+        return;
+
+    {
+        std::lock_guard Lock(_Mutex);
+
+        _IsDone = true;
+    }
+
+    _Condition.notify_one();
+
+    _Thread.join();
+
+    _IsActive = false;
+
+    Evaluate();
+}
+
+/// <summary>
+/// Stops the verification without evaluating the assertions.
+/// </summary>
+void spectrum_verifier_t::Cancel() noexcept
+{
+    if (!_Thread.joinable())
+        return;
+
+    {
+        std::lock_guard Lock(_Mutex);
+
+        _Queue.clear();
+        _IsDone = true;
+    }
+
+    _Condition.notify_one();
+
+    _Thread.join();
+
+    _IsActive = false;
+}
+
+/// <summary>
+/// Analyzes the queued samples until the verification is finished.
+/// </summary>
+void spectrum_verifier_t::Run() noexcept
+{
+    for (;;)
+    {
+        std::vector<double> Samples;
+
+        {
+            std::unique_lock Lock(_Mutex);
+
+            _Condition.wait(Lock, [this] { return !_Queue.empty() || _IsDone; });
+
+            if (_Queue.empty())
+                return;
+
+            Samples = std::move(_Queue.front());
+            _Queue.pop_front();
+        }
+
+        Analyze(Samples);
+    }
+}
+
+/// <summary>
+/// Adds half a block of samples. Every block that overlaps the previous one by 50% is windowed, transformed and its power spectrum is accumulated.
+/// </summary>
+void spectrum_verifier_t::Analyze(const std::vector<double> & samples) noexcept
+{
+    const size_t HopSize = _SegmentSize / 2;
+
+    std::copy(_Segment.begin() + (ptrdiff_t) HopSize, _Segment.end(), _Segment.begin());
+    std::copy(samples.begin(), samples.end(), _Segment.begin() + (ptrdiff_t) HopSize);
+
+    _SampleCount += HopSize;
+
+    if (_SampleCount < _SegmentSize)
+        return;
+
+    for (size_t i = 0; i < _SegmentSize; ++i)
+        _Windowed[i] = _Segment[i] * _Window[i];
+
+    _FFT->Transform(_Windowed.data(), _Spectrum.data());
+
+    for (size_t i = 0; i < _Power.size(); ++i)
+        _Power[i] += std::norm(_Spectrum[i]);
+
+    ++_SegmentCount;
+}
+
+/// <summary>
+/// Evaluates the assertions using the averaged power spectrum.
+/// </summary>
+void spectrum_verifier_t::Evaluate() const
+{
+    if (_SegmentCount == 0)
+        throw exception_io_data("Spectrum verification failed: not enough samples");
+
+    const double BinWidth = (double) _SampleRate / (double) _SegmentSize;
+
+    Log.AtInfo().Write(STR_COMPONENT_NAME " analyzed %zu blocks of %zu samples (%.2f Hz per bin).", _SegmentCount, _SegmentSize, BinWidth);
+
+    if (!std::isnan(_Fundamental))
+    {
+        const auto Peak = std::max_element(_Power.begin() + 1, _Power.end());
+        const double Frequency = (double) (Peak - _Power.begin()) * BinWidth;
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " Fundamental: %.2f Hz, expected %.2f Hz.", Frequency, _Fundamental);
+
+        if (std::abs(Frequency - _Fundamental) > BinWidth)
+            throw exception_io_data(msc::FormatText("Spectrum verification failed: fundamental is %.2f Hz instead of %.2f Hz", Frequency, _Fundamental).c_str());
+    }
+
+    if (!std::isnan(_MaxTHD))
+    {
+        const double FundamentalPower = GetBandPower(_Fundamental);
+
+        double HarmonicPower = 0.;
+
+        for (int Harmonic = 2; (Harmonic <= 10) && (Harmonic * _Fundamental < _SampleRate / 2.); ++Harmonic)
+            HarmonicPower += GetBandPower(Harmonic * _Fundamental);
+
+        const double THD = (HarmonicPower > 0.) ? 10. * std::log10(HarmonicPower / FundamentalPower) : -std::numeric_limits<double>::infinity();
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " THD: %.2f dB, maximum %.2f dB.", THD, _MaxTHD);
+
+        if (THD > _MaxTHD)
+            throw exception_io_data(msc::FormatText("Spectrum verification failed: THD is %.2f dB, maximum is %.2f dB", THD, _MaxTHD).c_str());
+    }
+
+    if (!std::isnan(_Slope))
+    {
+        // Fit a line through the mean power density of 1/3 octave bands as a function of the octave number.
+        double n = 0., Sx = 0., Sy = 0., Sxx = 0., Sxy = 0.;
+
+        for (double Frequency = _MinSlopeFrequency; Frequency * std::exp2(1. / 3.) <= _MaxSlopeFrequency; Frequency *= std::exp2(1. / 3.))
+        {
+            const size_t Lo = (size_t) std::ceil(Frequency / BinWidth);
+            const size_t Hi = std::min((size_t) std::ceil(Frequency * std::exp2(1. / 3.) / BinWidth), _Power.size());
+
+            if (Lo >= Hi)
+                continue;
+
+            double Power = 0.;
+
+            for (size_t i = Lo; i < Hi; ++i)
+                Power += _Power[i];
+
+            Power /= (double) (Hi - Lo);
+
+            if (Power <= 0.)
+                continue;
+
+            const double x = std::log2(Frequency * std::exp2(1. / 6.));
+            const double y = 10. * std::log10(Power);
+
+            n += 1.; Sx += x; Sy += y; Sxx += x * x; Sxy += x * y;
+        }
+
+        if (n < 2.)
+            throw exception_io_data("Spectrum verification failed: slope range is too narrow");
+
+        const double Slope = (n * Sxy - Sx * Sy) / (n * Sxx - Sx * Sx);
+
+        Log.AtInfo().Write(STR_COMPONENT_NAME " Slope: %.2f dB/octave, expected %.2f +/- %.2f dB/octave.", Slope, _Slope, _SlopeTolerance);
+
+        if (std::abs(Slope - _Slope) > _SlopeTolerance)
+            throw exception_io_data(msc::FormatText("Spectrum verification failed: slope is %.2f dB/octave instead of %.2f dB/octave", Slope, _Slope).c_str());
+    }
+
+    Log.AtInfo().Write(STR_COMPONENT_NAME " output matches the spectrum specification.");
+}
+
+/// <summary>
+/// Gets the power of the component at the specified frequency, including the leakage of the Hann window into the neighbouring bins.
+/// </summary>
+double spectrum_verifier_t::GetBandPower(double frequency) const noexcept
+{
+    const size_t Center = (size_t) std::round(frequency * (double) _SegmentSize / (double) _SampleRate);
+
+    const size_t Lo = (Center > 3) ? Center - 3 : 1;
+    const size_t Hi = std::min(Center + 4, _Power.size());
+
+    double Power = 0.;
+
+    for (size_t i = Lo; i < Hi; ++i)
+        Power += _Power[i];
+
+    return Power;
+}
@@ -0,0 +1,75 @@
+
+/** $VER: SpectrumVerifier.h (2026.10.19) P. Stuer - Verifies the spectrum of the generated output **/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "FFT.h"
+#include "SignalDocument.h"
+
+/// <summary>
+/// Implements a verification of the spectrum of the generated output against the assertions in a specification ("<file>.spectrum").
+/// The power spectrum of one channel is estimated with Welch's method (Hann window, 50% overlap) on a worker thread while the output is generated.
+/// </summary>
+class spectrum_verifier_t
+{
+public:
+    spectrum_verifier_t() noexcept;
+    ~spectrum_verifier_t() { Cancel(); }
+
+    void Start(const signal_document_t & spec, uint32_t sampleRate, uint32_t channelCount);
+    void Update(const audio_sample * data, size_t frameCount);
+    void Finish();
+    void Cancel() noexcept;
+
+    bool IsActive() const noexcept { return _IsActive; }
+
+private:
+    void Run() noexcept;
+    void Analyze(const std::vector<double> & samples) noexcept;
+
+    void Evaluate() const;
+
+    double GetBandPower(double frequency) const noexcept;
+
+private:
+    bool _IsActive;
+
+    uint32_t _SampleRate;
+    uint32_t _ChannelCount;
+    uint32_t _Channel;          // 0-based index of the channel to analyze
+    size_t _SegmentSize;
+
+    // Assertions. Not a number if not specified.
+    double _Fundamental;        // Expected frequency of the strongest component in Hz
+    double _MaxTHD;             // Maximum total harmonic distortion in dB
+    double _Slope;              // Expected slope of the spectrum in dB per octave
+    double _SlopeTolerance;
+    double _MinSlopeFrequency;
+    double _MaxSlopeFrequency;
+
+    // Producer
+    std::vector<double> _Pending;
+
+    // Worker
+    std::thread _Thread;
+    std::mutex _Mutex;
+    std::condition_variable _Condition;
+    std::deque<std::vector<double>> _Queue;
+    bool _IsDone;
+
+    std::unique_ptr<real_fft_t> _FFT;
+    std::vector<double> _Window;
+    std::vector<double> _Segment;
+    std::vector<double> _Windowed;
+    std::vector<std::complex<double>> _Spectrum;
+    std::vector<double> _Power;     // Sum of the power spectra of all segments
+    size_t _SampleCount;
+    size_t _SegmentCount;
+};
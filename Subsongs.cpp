@@ -0,0 +1,305 @@
+
+/** $VER: Subsongs.cpp (2026.10.19) P. Stuer - Finds the subsongs of a Csound document **/
+
+#include "pch.h"
+
+#include "Subsongs.h"
+
+#include "Resources.h"
+#include "Log.h"
+
+#pragma hdrstop
+
+static std::vector<subsong_t> GetInstruments(const char * head, const char * tail);
+static std::vector<subsong_t> GetSections(const char * head, const char * tail);
+static bool HasTempoOption(const char * text) noexcept;
+static std::vector<std::string> Tokenize(const char * head, const char * tail);
+static bool ToNumber(const std::string & token, double & value) noexcept;
+
+static const char InstrumentPrefix[] = "Subsong";
+
+/// <summary>
+/// Gets the subsongs of a Csound document. Instruments whose name starts with "Subsong" are played as subsongs. Otherwise, every section of the score is a subsong.
+/// Returns an empty list if the document contains only one subsong or if the sections can't be determined.
+/// </summary>
+std::vector<subsong_t> GetSubsongs(const char * text)
+{
+    const char * OrchestraHead = ::strstr(text, "<CsInstruments>");
+    const char * OrchestraTail = (OrchestraHead != nullptr) ? ::strstr(OrchestraHead, "</CsInstruments>") : nullptr;
+
+    if (OrchestraTail != nullptr)
+    {
+        auto Subsongs = GetInstruments(OrchestraHead, OrchestraTail);
+
+        if (!Subsongs.empty())
+            return Subsongs;
+    }
+
+    const char * ScoreHead = ::strstr(text, "<CsScore>");
+    const char * ScoreTail = (ScoreHead != nullptr) ? ::strstr(ScoreHead, "</CsScore>") : nullptr;
+
+    if ((ScoreTail != nullptr) && !HasTempoOption(text))
+        return GetSections(ScoreHead + 9, ScoreTail);
+
+    return { };
+}
+
+/// <summary>
+/// Gets the instruments that are played as subsongs.
+/// </summary>
+static std::vector<subsong_t> GetInstruments(const char * head, const char * tail)
+{
+    std::vector<subsong_t> Subsongs;
+
+    for (const char * Line = head; Line < tail;)
+    {
+        const char * LineTail = Line;
+
+        while ((LineTail < tail) && (*LineTail != '\n'))
+            ++LineTail;
+
+        const char * p = Line;
+
+        while ((p < LineTail) && std::isspace((unsigned char) *p))
+            ++p;
+
+        if ((LineTail - p > 6) && (::strncmp(p, "instr", 5) == 0) && std::isspace((unsigned char) p[5]))
+        {
+            // An instrument can have several names and numbers, separated by commas.
+            std::string Names(p + 6, LineTail);
+
+            Names = Names.substr(0, Names.find(';'));
+
+            for (size_t Head = 0; Head < Names.size();)
+            {
+                size_t Tail = Names.find(',', Head);
+
+                if (Tail == std::string::npos)
+                    Tail = Names.size();
+
+                std::string Name = Names.substr(Head, Tail - Head);
+
+                Name.erase(0, Name.find_first_not_of(" \t"));
+                Name.erase(Name.find_last_not_of(" \t\r") + 1);
+
+                if ((Name.size() > sizeof(InstrumentPrefix) - 1) && Name.starts_with(InstrumentPrefix))
+                {
+                    std::string Title = Name.substr(sizeof(InstrumentPrefix) - 1);
+
+                    Title.erase(0, Title.find_first_not_of('_'));
+
+                    Subsongs.push_back({ Title.empty() ? Name : Title, Name, 0., 0. });
+                }
+
+                Head = Tail + 1;
+            }
+        }
+
+        Line = (LineTail < tail) ? LineTail + 1 : tail;
+    }
+
+    return Subsongs;
+}
+
+/// <summary>
+/// Gets the sections of the score. Their start times are calculated from the start time and duration of the events, so only scores that don't change the time base are supported.
+/// </summary>
+static std::vector<subsong_t> GetSections(const char * head, const char * tail)
+{
+    std::vector<subsong_t> Subsongs;
+
+    double Offset = 0.;
+    double SectionEnd = 0.;
+    double LastTime = 0.;
+    double LastDuration = 0.;
+    bool HasStatements = false;
+
+    auto EndSection = [&](double time)
+    {
+        SectionEnd = std::max(SectionEnd, time);
+
+        Subsongs.push_back({ msc::FormatText("Section %zu", Subsongs.size() + 1), "", Offset, SectionEnd });
+
+        Offset += SectionEnd;
+        SectionEnd = LastTime = LastDuration = 0.;
+        HasStatements = false;
+    };
+
+    for (const char * Line = head; Line < tail;)
+    {
+        const char * LineTail = Line;
+
+        while ((LineTail < tail) && (*LineTail != '\n'))
+            ++LineTail;
+
+        const char * p = Line;
+
+        while ((p < LineTail) && std::isspace((unsigned char) *p))
+            ++p;
+
+        Line = (LineTail < tail) ? LineTail + 1 : tail;
+
+        if ((p == LineTail) || (*p == ';'))
+            continue;
+
+        const char Statement = *p;
+
+        std::vector<std::string> Tokens = Tokenize(p + 1, LineTail);
+
+        double Time = 0.;
+
+        switch (Statement)
+        {
+            case 'i':
+            {
+                if (Tokens.size() < 3)
+                    return { };
+
+                const std::string & P2 = Tokens[1];
+                const std::string & P3 = Tokens[2];
+
+                if (P2 == ".")
+                    Time = LastTime;
+                else
+                if (P2 == "+")
+                    Time = LastTime + LastDuration;
+                else
+                if (P2.starts_with("^") && ToNumber(P2.substr(1), Time))
+                    Time += LastTime;
+                else
+                if (!ToNumber(P2, Time))
+                    return { };
+
+                double Duration;
+
+                if (P3 == ".")
+                    Duration = LastDuration;
+                else
+                if (!ToNumber(P3, Duration))
+                    return { };
+
+                LastTime = Time;
+                LastDuration = Duration;
+
+                SectionEnd = std::max(SectionEnd, Time + std::max(Duration, 0.));
+                HasStatements = true;
+                break;
+            }
+
+            case 'f':
+            {
+                if ((Tokens.size() < 2) || !ToNumber(Tokens[1], Time))
+                    return { };
+
+                SectionEnd = std::max(SectionEnd, Time);
+                HasStatements = true;
+                break;
+            }
+
+            case 's':
+            case 'e':
+            {
+                if (!Tokens.empty() && !ToNumber(Tokens[0], Time))
+                    return { };
+
+                EndSection(Time);
+
+                if (Statement == 'e')
+                    return (Subsongs.size() > 1) ? Subsongs : std::vector<subsong_t>();
+                break;
+            }
+
+            default:
+                // Any other statement, macro or expression may change the time base.
+                return { };
+        }
+    }
+
+    if (HasStatements)
+        EndSection(0.);
+
+    return (Subsongs.size() > 1) ? Subsongs : std::vector<subsong_t>();
+}
+
+/// <summary>
+/// Returns true if the options of the document set the tempo. A tempo set on the command line changes the meaning of the start times.
+/// </summary>
+static bool HasTempoOption(const char * text) noexcept
+{
+    const char * OptionsHead = ::strstr(text, "<CsOptions>");
+    const char * OptionsTail = (OptionsHead != nullptr) ? ::strstr(OptionsHead, "</CsOptions>") : nullptr;
+
+    if (OptionsTail == nullptr)
+        return false;
+
+    for (const char * p = OptionsHead + 11; p < OptionsTail; ++p)
+    {
+        // An option starts at the beginning of the options or after white space.
+        if ((p != OptionsHead + 11) && !std::isspace((unsigned char) p[-1]))
+            continue;
+
+        if ((OptionsTail - p >= 2) && (::strncmp(p, "-t", 2) == 0))
+            return true;
+
+        if ((OptionsTail - p >= 7) && (::strncmp(p, "--tempo", 7) == 0))
+            return true;
+    }
+
+    return false;
+}
+
+/// <summary>
+/// Splits the p-fields of a statement into tokens. A p-field that immediately follows the statement letter is a separate token.
+/// </summary>
+static std::vector<std::string> Tokenize(const char * head, const char * tail)
+{
+    std::vector<std::string> Tokens;
+
+    const char * p = head;
+
+    while (p < tail)
+    {
+        while ((p < tail) && std::isspace((unsigned char) *p))
+            ++p;
+
+        if ((p == tail) || (*p == ';'))
+            break;
+
+        const char * TokenHead = p;
+
+        if (*p == '"')
+        {
+            ++p;
+
+            while ((p < tail) && (*p != '"'))
+                ++p;
+
+            if (p < tail)
+                ++p;
+        }
+        else
+        {
+            while ((p < tail) && !std::isspace((unsigned char) *p) && (*p != ';'))
+                ++p;
+        }
+
+        Tokens.emplace_back(TokenHead, p);
+    }
+
+    return Tokens;
+}
+
+/// <summary>
+/// Converts a token to a number. The score constant 'z' is not accepted because it makes the duration infinite.
+/// </summary>
+static bool ToNumber(const std::string & token, double & value) noexcept
+{
+    if (token.empty())
+        return false;
+
+    char * End;
+
+    value = std::strtod(token.c_str(), &End);
+
+    return (*End == '\0') && std::isfinite(value);
+}
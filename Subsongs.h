@@ -0,0 +1,20 @@
+
+/** $VER: Subsongs.h (2026.10.19) P. Stuer - Finds the subsongs of a Csound document **/
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Represents a part of a Csound document that is played as a subsong: a section of the score or an instrument.
+/// </summary>
+struct subsong_t
+{
+    std::string Name;
+    std::string Instrument; // Name of the instrument that is played, empty for a score section
+    double Offset;          // Start time of the section in the score in seconds
+    double Duration;        // Duration in seconds, 0 if infinite
+};
+
+std::vector<subsong_t> GetSubsongs(const char * text);
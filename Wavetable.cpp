@@ -0,0 +1,79 @@
+
+/** $VER: Wavetable.cpp (2026.10.19) P. Stuer - Shared, cache-aligned wavetables **/
+
+#include "pch.h"
+
+#include "Wavetable.h"
+
+#include <map>
+#include <numbers>
+
+#pragma hdrstop
+
+/// <summary>
+/// Initializes a new instance.
+/// </summary>
+wavetable_t::wavetable_t(size_t size) : _Size(size)
+{
+    if ((size < 4) || !std::has_single_bit(size))
+        throw exception_io_data("Wavetable size must be a power of 2");
+
+    _Data = (double *) ::operator new[]((size + 1) * sizeof(double), std::align_val_t(CacheLineSize));
+}
+
+/// <summary>
+/// Destroys this instance.
+/// </summary>
+wavetable_t::~wavetable_t() noexcept
+{
+    ::operator delete[](_Data, std::align_val_t(CacheLineSize));
+}
+
+/// <summary>
+/// Gets the sine table with the specified size. Tables are shared by all decoder instances and live as long as one of them uses it.
+/// </summary>
+std::shared_ptr<const wavetable_t> wavetable_t::GetSine(size_t size)
+{
+    static msc::critical_section_t Lock;
+    static std::map<size_t, std::weak_ptr<const wavetable_t>> Tables;
+
+    Lock.Enter();
+
+    std::shared_ptr<const wavetable_t> Table = Tables[size].lock();
+
+    Lock.Leave();
+
+    if (Table)
+        return Table;
+
+    // Calculate the table outside the lock. Two threads may occasionally both do the work, but only one of the tables survives.
+    auto NewTable = std::make_shared<wavetable_t>(size);
+
+    const size_t Quarter = size / 4;
+
+    // Calculate the first quadrant only and mirror it, so the table is exactly symmetric.
+    for (size_t i = 0; i <= Quarter; ++i)
+        NewTable->_Data[i] = std::sin(2. * std::numbers::pi * (double) i / (double) size);
+
+    for (size_t i = 1; i < Quarter; ++i)
+        NewTable->_Data[Quarter + i] = NewTable->_Data[Quarter - i];
+
+    for (size_t i = 0; i < size / 2; ++i)
+        NewTable->_Data[(size / 2) + i] = -NewTable->_Data[i];
+
+    NewTable->_Data[size] = NewTable->_Data[0];
+
+    Lock.Enter();
+
+    Table = Tables[size].lock();
+
+    if (!Table)
+    {
+        Table = NewTable;
+        Tables[size] = Table;
+    }
+
+    Lock.Leave();
+
+    return Table;
+}
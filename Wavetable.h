@@ -0,0 +1,34 @@
+
+/** $VER: Wavetable.h (2026.10.19) P. Stuer - Shared, cache-aligned wavetables **/
+
+#pragma once
+
+#include <memory>
+
+/// <summary>
+/// Implements a read-only table containing exactly one period of a waveform. The size is always a power of 2.
+/// </summary>
+class wavetable_t
+{
+public:
+    wavetable_t(size_t size);
+
+    wavetable_t(const wavetable_t &) = delete;
+    wavetable_t & operator=(const wavetable_t &) = delete;
+    wavetable_t(wavetable_t &&) = delete;
+    wavetable_t & operator=(wavetable_t &&) = delete;
+
+    ~wavetable_t() noexcept;
+
+    const double * Data() const noexcept { return _Data; }
+    size_t Size() const noexcept { return _Size; }
+    size_t Mask() const noexcept { return _Size - 1; }
+
+    static std::shared_ptr<const wavetable_t> GetSine(size_t size);
+
+private:
+    double * _Data; // One extra guard sample that repeats the first one allows interpolation without wrapping.
+    size_t _Size;
+
+    static const size_t CacheLineSize = 64;
+};